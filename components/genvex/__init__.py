@@ -11,10 +11,16 @@ genvex_ns = cg.esphome_ns.namespace('genvex')
 Genvex = genvex_ns.class_('Genvex', cg.PollingComponent, modbus.ModbusDevice)
 
 CONF_GENVEX_ID = 'genvex_id'
+CONF_FRAME_GAP = 'frame_gap'
+CONF_MAX_BLOCK_SIZE = 'max_block_size'
+CONF_MAX_GAP = 'max_gap'
 
 CONFIG_SCHEMA = cv.Schema({
     cv.GenerateID(): cv.declare_id(Genvex),
     cv.Required(CONF_ADDRESS): cv.int_range(min=1, max=100),
+    cv.Optional(CONF_FRAME_GAP, default='50ms'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_MAX_BLOCK_SIZE, default=16): cv.int_range(min=1, max=125),
+    cv.Optional(CONF_MAX_GAP, default=8): cv.int_range(min=0, max=124),
     
 }).extend(cv.polling_component_schema('60s')).extend(modbus.modbus_device_schema(0x01))
 
@@ -27,3 +33,6 @@ def to_code(config):
         cg.add(var.set_address(config[CONF_ADDRESS]))
     if CONF_UPDATE_INTERVAL in config:
         cg.add(var.set_update_interval(config[CONF_UPDATE_INTERVAL]))
+    cg.add(var.set_frame_gap(config[CONF_FRAME_GAP]))
+    cg.add(var.set_max_block_size(config[CONF_MAX_BLOCK_SIZE]))
+    cg.add(var.set_max_gap(config[CONF_MAX_GAP]))
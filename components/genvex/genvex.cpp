@@ -9,248 +9,291 @@ static const char *TAG = "genvex";
 static const uint8_t CMD_READ_INPUT_REG = 0x04;
 static const uint8_t CMD_READ_HOLDING_REG = 0x03;
 static const uint8_t CMD_WRITE_SINGLE_REG = 0x06;
-static const uint8_t CMD_FUNCTION_REG = 0x04;
-static const uint16_t REGISTER_START[] = {0, 100, 0, 100};
-static const uint16_t REGISTER_COUNT[] = {12, 10, 1, 7};
-static const uint16_t REGISTER_WRITE[] = {4};
+static const uint16_t REGISTER_TARGET_TEMP = 0;
+static const uint16_t REGISTER_SPEED_MODE = 100;
+static const uint8_t WRITE_ATTEMPTS = 3;
+// Tries of one poll read before it is skipped for the rest of the cycle
+static const uint8_t READ_ATTEMPTS = 3;
+
+// One decoded register: value = (raw + offset) / divisor, published to the sensor in slot
+struct RegisterMapping {
+  uint8_t function;
+  uint16_t address;
+  int16_t offset;
+  uint8_t divisor;
+  uint8_t slot;
+  const char *name;
+};
+
+// Ordered by address per register type, the read planner relies on it
+static constexpr RegisterMapping REGISTER_MAP[] = {
+    {CMD_READ_INPUT_REG, 0, -300, 10, SENSOR_TEMP_T1, "Temp_t1"},
+    {CMD_READ_INPUT_REG, 1, -300, 10, SENSOR_TEMP_T2, "Temp_t2"},
+    {CMD_READ_INPUT_REG, 2, -300, 10, SENSOR_TEMP_T3, "Temp_t3"},
+    {CMD_READ_INPUT_REG, 3, -300, 10, SENSOR_TEMP_T4, "Temp_t4"},
+    {CMD_READ_INPUT_REG, 4, -300, 10, SENSOR_TEMP_T5, "Temp_t5"},
+    {CMD_READ_INPUT_REG, 5, -300, 10, SENSOR_TEMP_T6, "Temp_t6"},
+    {CMD_READ_INPUT_REG, 6, -300, 10, SENSOR_TEMP_T7, "Temp_t7"},
+    {CMD_READ_INPUT_REG, 7, -300, 10, SENSOR_TEMP_T8, "Temp_t8"},
+    {CMD_READ_INPUT_REG, 8, -300, 10, SENSOR_TEMP_T9, "Temp_t9"},
+    {CMD_READ_INPUT_REG, 9, -300, 10, SENSOR_TEMP_T2_PANEL, "Temp_t2_panel"},
+    {CMD_READ_INPUT_REG, 10, 0, 1, SENSOR_MEASURED_HUMIDITY, "Measured_Humidity"},
+    {CMD_READ_INPUT_REG, 11, 0, 1, SENSOR_HUMIDITY_CALCULATED_SETPOINT, "Humidity_Calculated_Setpoint"},
+    {CMD_READ_INPUT_REG, 101, 0, 1, SENSOR_ALARM_BIT, "Alarm_Bit"},
+    {CMD_READ_INPUT_REG, 102, 0, 1, SENSOR_INLET_FAN, "Inlet_Fan"},
+    {CMD_READ_INPUT_REG, 103, 0, 1, SENSOR_EXTRACT_FAN, "Extract_Fan"},
+    {CMD_READ_INPUT_REG, 104, 0, 1, SENSOR_BYPASS, "Bypass"},
+    {CMD_READ_INPUT_REG, 105, 0, 1, SENSOR_WATERVALVE, "Watervalve"},
+    {CMD_READ_INPUT_REG, 106, 0, 1, SENSOR_HUMIDITY_FAN_CONTROL, "Humidity_Fan_Control"},
+    {CMD_READ_INPUT_REG, 107, 0, 1, SENSOR_BYPASS_ON_OFF, "Bypass_On_Off"},
+    {CMD_READ_HOLDING_REG, 0, 100, 10, SENSOR_TARGET_TEMP, "Target_Temp"},
+    {CMD_READ_HOLDING_REG, 100, 0, 1, SENSOR_SPEED_MODE, "Speed_Mode"},
+    {CMD_READ_HOLDING_REG, 102, 0, 1, SENSOR_HEAT, "Heat"},
+    {CMD_READ_HOLDING_REG, 106, 0, 1, SENSOR_TIMER, "Timer"},
+};
+
+// Every slot appears once and addresses go up within each register type
+static constexpr bool register_map_valid() {
+  uint32_t slots = 0;
+  const RegisterMapping *previous = nullptr;
+  for (const auto &reg : REGISTER_MAP) {
+    if (reg.divisor == 0 || (slots & (1UL << reg.slot)))
+      return false;
+    if (previous != nullptr && previous->function == reg.function && previous->address >= reg.address)
+      return false;
+    slots |= 1UL << reg.slot;
+    previous = &reg;
+  }
+  return slots == (1UL << SENSOR_COUNT) - 1;
+}
+static_assert(register_map_valid(), "Genvex register map is inconsistent");
+
+// The target temperature and speed mode are always decoded, the climate follows them through the callbacks
+static const uint32_t CALLBACK_MASK = (1UL << SENSOR_TARGET_TEMP) | (1UL << SENSOR_SPEED_MODE);
 
 void Genvex::add_target_temp_callback(std::function<void(float)> &&callback) { target_temp_callback_.add(std::move(callback)); }
 void Genvex::add_fan_speed_callback(std::function<void(int)> &&callback) { fan_speed_callback_.add(std::move(callback)); }
 
+// Plans the reads of a poll cycle. The registers of the configured sensors are merged into as few reads as possible
+// per register type: the next register joins the current read when at most max_gap_ unused registers lie in between
+// and the read stays within max_block_size_ registers. Taking registers in address order this way gives the
+// smallest number of reads, and registers nothing is configured for are never read.
+void Genvex::setup() {
+  for (float &published : published_)
+    published = NAN;
+  uint32_t needed = sensor_mask_ | CALLBACK_MASK;
+  GenvexRead *read = nullptr;
+  read_count_ = 0;
+  for (const auto &reg : REGISTER_MAP) {
+    if (!(needed & (1UL << reg.slot)))
+      continue;
+    if (read != nullptr && read->function == reg.function &&
+        reg.address - (read->start + read->count) <= max_gap_ && reg.address + 1 - read->start <= max_block_size_) {
+      read->count = reg.address + 1 - read->start;
+    } else {
+      read = &reads_[read_count_++];
+      read->function = reg.function;
+      read->start = reg.address;
+      read->count = 1;
+    }
+  }
+  for (uint8_t i = 0; i < read_count_; i++)
+    ESP_LOGD(TAG, "Read %d: function 0x%02X, registers %u-%u", i + 1, reads_[i].function, reads_[i].start,
+             reads_[i].start + reads_[i].count - 1);
+}
+
 void Genvex::on_modbus_data(const std::vector<uint8_t> &data) {
-	uint32_t raw_32;
-	uint16_t raw_16;
-  
-	auto get_16bit = [&](size_t i) -> uint16_t {
-		return (uint16_t(data[i]) << 8) | uint16_t(data[i + 1]);
-	};
-  
-	this->waiting_ = false;
-	if (!waiting_for_write_ack_ && data.size() < REGISTER_COUNT[this->state_ - 1] * 2) {
-		ESP_LOGW(TAG, "Invalid data packet size (%d) for state %d", data.size(), this->state_);
-		return;
-	}
-	ESP_LOGD(TAG, "Data: %s", hexencode(data).c_str());
+  this->waiting_ = false;
+  this->last_reply_ = millis();
 
-	//  Command response is 4 bytes echoing the write command
-	if (waiting_for_write_ack_ )  {
-		waiting_for_write_ack_ = false ; 
-		if (data.size() == 4) {
-			ESP_LOGD(TAG, "Write command succeeded");
-		} else {
-			ESP_LOGW(TAG, "Invalid data packet size (%d) while waiting for write command response", data.size());
-		}
-		return ; 
-	}
+  //  Command response is 4 bytes echoing the register and value written. A write that isn't confirmed stays queued
+  //  and is sent again.
+  if (waiting_for_write_ack_) {
+    waiting_for_write_ack_ = false;
+    if (data.size() != 4) {
+      ESP_LOGW(TAG, "Invalid data packet size (%d) while waiting for write command response", data.size());
+      return;
+    }
+    uint16_t address = (uint16_t(data[0]) << 8) | data[1];
+    uint16_t value = (uint16_t(data[2]) << 8) | data[3];
+    if (address != write_address_ || value != write_value_) {
+      ESP_LOGW(TAG, "Write response for register %u (%u) doesn't match the write of register %u (%u)", address, value,
+               write_address_, write_value_);
+      return;
+    }
+    ESP_LOGD(TAG, "Write of register %u (%u) succeeded", address, value);
+    // a newer value for the same register may have been queued meanwhile, that one still has to go out
+    for (uint8_t i = 0; i < write_count_; i++) {
+      if (writes_[i].address == address && writes_[i].value == value) {
+        remove_write_(i);
+        break;
+      }
+    }
+    return;
+  }
 
-	if (this->state_ == 1) {
-		this->state_ = 2;
-		
-		// Temperatures
-		raw_16 = get_16bit(0);
-		float t1 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(2);
-		float t2 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(4);
-		float t3 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(6);
-		float t4 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(8);
-		float t5 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(10);
-		float t6 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(12);
-		float t7 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(14);
-		float t8 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(16);
-		float t9 = (raw_16 - 300.0) / 10;
-		raw_16 = get_16bit(18);
-		float t2_panel = (raw_16 - 300.0) / 10;
-		
-		// Humidity
-		raw_16 = get_16bit(20);
-		float measured_humidity = raw_16;
-		raw_16 = get_16bit(22);
-		float humidity_calculated_setpoint = raw_16;
-  
-		ESP_LOGD(TAG, "GENVEX Humidity: H=%.1f %%, HCS=%.lf %%", measured_humidity, humidity_calculated_setpoint);
-		ESP_LOGD(TAG, "GENVEX Temperature: T1=%.1f °C, T2=%.1f °C, T3=%.1f °C, T4=%.1f °C, T5=%.1f °C, T6=%.1f °C, T7=%.1f °C, T8=%.1f °C, T9=%.1f °C, T2_Panel=%.1f °C", t1, t2, t3, t4, t5, t6, t7, t8, t9, t2_panel);
-		
-		// Temperatures
-		if (this->temp_t1_sensor_ != nullptr)
-			this->temp_t1_sensor_->publish_state(t1);
-		if (this->temp_t2_sensor_ != nullptr)
-			this->temp_t2_sensor_->publish_state(t2);
-		if (this->temp_t3_sensor_ != nullptr)
-			this->temp_t3_sensor_->publish_state(t3);
-		if (this->temp_t4_sensor_ != nullptr)
-			this->temp_t4_sensor_->publish_state(t4);
-		if (this->temp_t5_sensor_ != nullptr)
-			this->temp_t5_sensor_->publish_state(t5);
-		if (this->temp_t6_sensor_ != nullptr)
-			this->temp_t6_sensor_->publish_state(t6);
-		if (this->temp_t7_sensor_ != nullptr)
-			this->temp_t7_sensor_->publish_state(t7);
-		if (this->temp_t8_sensor_ != nullptr)
-			this->temp_t8_sensor_->publish_state(t8);
-		if (this->temp_t9_sensor_ != nullptr)
-			this->temp_t9_sensor_->publish_state(t9);
-		if (this->temp_t2_panel_sensor_ != nullptr)
-			this->temp_t2_panel_sensor_->publish_state(t2_panel);
-		
-		// Humidity
-		if (this->measured_humidity_sensor_ != nullptr)
-			this->measured_humidity_sensor_->publish_state(measured_humidity);
-		if (this->humidity_calculated_setpoint_sensor_ != nullptr)
-			this->humidity_calculated_setpoint_sensor_->publish_state(humidity_calculated_setpoint);
-		
-		return;
-	}
-	
-	if (this->state_ == 2) {
-		this->state_ = 3;
-		this->CMD_FUNCTION_REG = 0x03;
-		
-		raw_16 = get_16bit(2);
-		float alarm_bit = raw_16;
-		raw_16 = get_16bit(4);
-		float inlet_fan = raw_16;
-		raw_16 = get_16bit(6);
-		float extract_fan = raw_16;
-		raw_16 = get_16bit(8);
-		float bypass = raw_16;
-		raw_16 = get_16bit(10);
-		float watervalve = raw_16;
-		raw_16 = get_16bit(12);
-		float humidity_fan_control = raw_16;
-		raw_16 = get_16bit(14);
-		float bypass_on_off = raw_16;
-		
-		ESP_LOGD(TAG, "Alarm: Alarm=%.2f", alarm_bit);
-		ESP_LOGD(TAG, "Runinfo: Inlet=%.2f %%, Extract=%.2f %%, Bypass=%.2f %%, Watervalve=%.2f %%, Humidity_fan_control=%.2f %%, Bypass_on_off=%.2f", inlet_fan, extract_fan, bypass, watervalve, humidity_fan_control, bypass_on_off);
-		if (this->alarm_bit_sensor_ != nullptr)
-			this->alarm_bit_sensor_->publish_state(alarm_bit);
-		if (this->inlet_fan_sensor_ != nullptr)
-			this->inlet_fan_sensor_->publish_state(inlet_fan);
-		if (this->extract_fan_sensor_ != nullptr)
-			this->extract_fan_sensor_->publish_state(extract_fan);
-		if (this->bypass_sensor_ != nullptr)
-			this->bypass_sensor_->publish_state(bypass);
-		if (this->watervalve_sensor_ != nullptr)
-			this->watervalve_sensor_->publish_state(watervalve);
-		if (this->humidity_fan_control_sensor_ != nullptr)
-			this->humidity_fan_control_sensor_->publish_state(humidity_fan_control);
-		if (this->bypass_on_off_sensor_ != nullptr)
-			this->bypass_on_off_sensor_->publish_state(bypass_on_off);
-		
-		
-		return;
-	}
-	
-	if (this->state_ == 3) {
-		this->state_ = 4;
-		this->CMD_FUNCTION_REG = 0x03;
-		
-		raw_16 = get_16bit(0);
-		float target_temp = (raw_16 + 100) / 10;
-		
-		ESP_LOGD(TAG, "Target_temp: Target_Temp=%.2f", target_temp);
-		if (this->target_temp_sensor_ != nullptr)
-			this->target_temp_sensor_->publish_state(target_temp);
-		target_temp_callback_.call(target_temp);
-		return;
-	}
-	
-	if (this->state_ == 4) {
-		this->state_ = 0;
-		this->CMD_FUNCTION_REG = 0x04;
-		
-		raw_16 = get_16bit(0);
-		int speed_mode = raw_16;
-		raw_16 = get_16bit(4);
-		float heat = raw_16;
-		raw_16 = get_16bit(12);
-		float timer = raw_16;
-		
-		ESP_LOGD(TAG, "Speed: Speed_Mode=%d, heat=%.2f, timer=%.2f" , speed_mode, heat, timer);
-		if (this->speed_mode_sensor_ != nullptr)
-			this->speed_mode_sensor_->publish_state(speed_mode);
-		fan_speed_callback_.call(speed_mode);
-		if (this->heat_sensor_ != nullptr)
-			this->heat_sensor_->publish_state(heat);
-		if (this->timer_sensor_ != nullptr)
-			this->timer_sensor_->publish_state(timer);
-		return;
-	}
+  if (this->state_ == 0 || data.size() < reads_[this->state_ - 1].count * 2) {
+    ESP_LOGW(TAG, "Invalid data packet size (%d) for state %d", data.size(), this->state_);
+    return;
+  }
+  ESP_LOGD(TAG, "Data: %s", hexencode(data).c_str());
+  const GenvexRead &read = reads_[this->state_ - 1];
+  this->state_ = this->state_ < read_count_ ? this->state_ + 1 : 0;
+  this->read_attempts_ = 0;
+
+  for (const auto &reg : REGISTER_MAP) {
+    if (reg.function != read.function || reg.address < read.start || reg.address >= read.start + read.count ||
+        !((sensor_mask_ | CALLBACK_MASK) & (1UL << reg.slot)))
+      continue;
+    size_t i = (reg.address - read.start) * 2;
+    uint16_t raw = (uint16_t(data[i]) << 8) | uint16_t(data[i + 1]);
+    float value = float(raw + reg.offset) / reg.divisor;
+    ESP_LOGV(TAG, "%s: %.1f", reg.name, value);
+    if (this->sensors_[reg.slot] != nullptr && should_publish_(reg.slot, value, this->last_reply_))
+      this->sensors_[reg.slot]->publish_state(value);
+    if (reg.slot == SENSOR_TARGET_TEMP)
+      target_temp_callback_.call(value);
+    else if (reg.slot == SENSOR_SPEED_MODE)
+      fan_speed_callback_.call(raw);
+  }
+}
+
+bool Genvex::should_publish_(uint8_t slot, float value, uint32_t now) {
+  const PublishPolicy &policy = policies_[slot];
+  float published = published_[slot];
+  bool due;
+  if (std::isnan(published) || (policy.heartbeat > 0 && now - last_publish_[slot] >= policy.heartbeat)) {
+    due = true;
+  } else if (now - last_publish_[slot] < policy.min_interval) {
+    due = false;
+  } else {
+    float deadband = policy.relative ? fabsf(published) * policy.deadband / 100 : policy.deadband;
+    due = fabsf(value - published) > deadband;
+  }
+  if (due) {
+    published_[slot] = value;
+    last_publish_[slot] = now;
+  }
+  return due;
 }
 
 void Genvex::loop() {
   long now = millis();
   // timeout after 15 seconds
-if (this->waiting_ && (now - this->last_send_ > 15000)) {
+  if (this->waiting_ && (now - this->last_send_ > 15000)) {
     ESP_LOGW(TAG, "timed out waiting for response");
     this->waiting_ = false;
+    this->waiting_for_write_ack_ = false;
+    this->last_reply_ = now;
+  }
+  // the reads of a cycle follow each other as soon as the previous reply is in, queued writes go first
+  if (this->waiting_ || (now - this->last_reply_ < frame_gap_))
+    return;
+  if (write_count_ > 0) {
+    send_write_();
+    return;
   }
-  if (this->waiting_ || (this->state_ == 0) || (now - this->last_send_ < 1000))
+  if (this->state_ == 0)
     return;
+  // a read the device doesn't answer must not hold up the reads after it, nor the next cycle
+  if (this->read_attempts_ >= READ_ATTEMPTS) {
+    this->skipped_reads_++;
+    ESP_LOGW(TAG, "Skipping read %d after %u attempts, %u skipped so far", this->state_, this->read_attempts_,
+             this->skipped_reads_);
+    this->state_ = this->state_ < read_count_ ? this->state_ + 1 : 0;
+    this->read_attempts_ = 0;
+    if (this->state_ == 0)
+      return;
+  }
   this->last_send_ = now;
-  this->send(CMD_FUNCTION_REG, REGISTER_START[this->state_ - 1], REGISTER_COUNT[this->state_ - 1]);
+  const GenvexRead &read = reads_[this->state_ - 1];
+  this->read_attempts_++;
+  this->send(read.function, read.start, read.count);
   this->waiting_ = true;
 }
 
-void Genvex::update() { this->state_ = 1; }
+// A cycle that is still running when the next update comes in is left to finish, restarting it would starve the
+// blocks at its end. The diagnostic counters are published once per update.
+void Genvex::update() {
+  bool running = this->state_ != 0;
+  if (running) {
+    this->overruns_++;
+    ESP_LOGW(TAG, "Poll cycle still at state %d on update, %u overruns so far", this->state_, this->overruns_);
+  }
+  if (this->overruns_sensor_ != nullptr)
+    this->overruns_sensor_->publish_state(this->overruns_);
+  if (this->skipped_reads_sensor_ != nullptr)
+    this->skipped_reads_sensor_->publish_state(this->skipped_reads_);
+  if (!running)
+    this->state_ = 1;
+}
+
+void Genvex::writeTargetTemperature(float new_target_temp) {
+  uint16_t new_temp = lroundf(new_target_temp * 10) - 100;
+  ESP_LOGD(TAG, "Queueing new target temp (%u)", new_temp);
+  queue_write_(REGISTER_TARGET_TEMP, new_temp);
+}
+
+void Genvex::writeFanMode(int new_fan_speed) {
+  ESP_LOGD(TAG, "Queueing new fan speed (%i)", new_fan_speed);
+  queue_write_(REGISTER_SPEED_MODE, new_fan_speed);
+}
 
-void Genvex::writeTargetTemperature(float new_target_temp)
-{
-	
-	ESP_LOGD(TAG, "Writing new target temp to system.... (%f)",(new_target_temp * 10 - 100));
-	
-	uint8_t payload[2];
-	uint16_t new_temp = new_target_temp * 10 - 100;
-	payload[0] = (new_temp / 256) & 0xFF;
-	payload[1] = new_temp & 0xFF;
-	waiting_for_write_ack_= true;
-	this->send(CMD_WRITE_SINGLE_REG, 0, 1,sizeof(payload),payload);
+// Writes wait for the next free bus slot, so they never collide with a poll read. A register that already has a
+// write queued only gets its value replaced.
+void Genvex::queue_write_(uint16_t address, uint16_t value) {
+  for (uint8_t i = 0; i < write_count_; i++) {
+    if (writes_[i].address == address) {
+      writes_[i].value = value;
+      writes_[i].attempts = 0;
+      return;
+    }
+  }
+  if (write_count_ == MAX_WRITES) {
+    ESP_LOGW(TAG, "Write queue full, dropping write of register %u", address);
+    return;
+  }
+  writes_[write_count_++] = {address, value, 0};
 }
 
-void Genvex::writeFanMode(int new_fan_speed)
-{
-	uint8_t payload[2];
-	ESP_LOGD(TAG, "Writing new fan speed to system.... (%i)",new_fan_speed);
-	payload[0] = (new_fan_speed / 256) & 0xFF;
-	payload[1] = new_fan_speed & 0xFF;
-	waiting_for_write_ack_ = true ;
-	this->send(CMD_WRITE_SINGLE_REG, 100, 1,sizeof(payload),payload);
+void Genvex::remove_write_(uint8_t index) {
+  for (uint8_t i = index + 1; i < write_count_; i++)
+    writes_[i - 1] = writes_[i];
+  write_count_--;
 }
 
+// Sends the oldest queued write, it is removed when the controller confirms it or after WRITE_ATTEMPTS tries
+void Genvex::send_write_() {
+  while (write_count_ > 0 && writes_[0].attempts >= WRITE_ATTEMPTS) {
+    ESP_LOGW(TAG, "Giving up on write of register %u (%u)", writes_[0].address, writes_[0].value);
+    remove_write_(0);
+  }
+  if (write_count_ == 0)
+    return;
+  GenvexWrite &write = writes_[0];
+  write.attempts++;
+  write_address_ = write.address;
+  write_value_ = write.value;
+  uint8_t payload[2] = {uint8_t(write.value >> 8), uint8_t(write.value & 0xFF)};
+  ESP_LOGD(TAG, "Writing register %u (%u), attempt %u", write.address, write.value, write.attempts);
+  this->last_send_ = millis();
+  waiting_for_write_ack_ = true;
+  this->waiting_ = true;
+  this->send(CMD_WRITE_SINGLE_REG, write.address, 1, sizeof(payload), payload);
+}
 
 void Genvex::dump_config() {
   ESP_LOGCONFIG(TAG, "GENVEX:");
   ESP_LOGCONFIG(TAG, "  Address: 0x%02X", this->address_);
+  ESP_LOGCONFIG(TAG, "  Frame gap: %u ms", this->frame_gap_);
+  ESP_LOGCONFIG(TAG, "  Reads per cycle: %u (max block size %u, max gap %u)", this->read_count_,
+                this->max_block_size_, this->max_gap_);
   
 
-  LOG_SENSOR("", "Temp_t1", this->temp_t1_sensor_);
-  LOG_SENSOR("", "Temp_t2", this->temp_t2_sensor_);
-  LOG_SENSOR("", "Temp_t3", this->temp_t3_sensor_);
-  LOG_SENSOR("", "Temp_t4", this->temp_t4_sensor_);
-  LOG_SENSOR("", "Temp_t5", this->temp_t5_sensor_);
-  LOG_SENSOR("", "Temp_t6", this->temp_t6_sensor_);
-  LOG_SENSOR("", "Temp_t7", this->temp_t7_sensor_);
-  LOG_SENSOR("", "Temp_t8", this->temp_t8_sensor_);
-  LOG_SENSOR("", "Temp_t9", this->temp_t9_sensor_);
-  LOG_SENSOR("", "Temp_t2_panel", this->temp_t2_panel_sensor_);
-  LOG_SENSOR("", "Measured_Humidity", this->measured_humidity_sensor_);
-  LOG_SENSOR("", "Humidity_Calculated_Setpoint", this->humidity_calculated_setpoint_sensor_);
-  LOG_SENSOR("", "Alarm_Bit", this->alarm_bit_sensor_);
-  LOG_SENSOR("", "Inlet_Fan", this->inlet_fan_sensor_);
-  LOG_SENSOR("", "Extract_Fan", this->extract_fan_sensor_);
-  LOG_SENSOR("", "Bypass_Sensor", this->bypass_sensor_);
-  LOG_SENSOR("", "Watervalve", this->watervalve_sensor_);
-  LOG_SENSOR("", "Target_Temp", this->target_temp_sensor_);
-  LOG_SENSOR("", "Speed_Mode", this->speed_mode_sensor_);
-  LOG_SENSOR("", "Heat", this->heat_sensor_);
-  LOG_SENSOR("", "Timer", this->timer_sensor_);
+  for (const auto &reg : REGISTER_MAP) {
+    if (this->sensors_[reg.slot] != nullptr)
+      ESP_LOGCONFIG(TAG, "  %s: '%s'", reg.name, this->sensors_[reg.slot]->get_name().c_str());
+  }
 }
 
 }  // namespace genvex
@@ -8,35 +8,77 @@
 namespace esphome {
 namespace genvex {
 
+// Sensor slots of the register map, the bit of a slot in the sensor mask tells whether that sensor is configured
+enum GenvexSensor : uint8_t {
+  SENSOR_TEMP_T1,
+  SENSOR_TEMP_T2,
+  SENSOR_TEMP_T3,
+  SENSOR_TEMP_T4,
+  SENSOR_TEMP_T5,
+  SENSOR_TEMP_T6,
+  SENSOR_TEMP_T7,
+  SENSOR_TEMP_T8,
+  SENSOR_TEMP_T9,
+  SENSOR_TEMP_T2_PANEL,
+  SENSOR_MEASURED_HUMIDITY,
+  SENSOR_HUMIDITY_CALCULATED_SETPOINT,
+  SENSOR_ALARM_BIT,
+  SENSOR_INLET_FAN,
+  SENSOR_EXTRACT_FAN,
+  SENSOR_BYPASS,
+  SENSOR_WATERVALVE,
+  SENSOR_HUMIDITY_FAN_CONTROL,
+  SENSOR_BYPASS_ON_OFF,
+  SENSOR_TARGET_TEMP,
+  SENSOR_SPEED_MODE,
+  SENSOR_HEAT,
+  SENSOR_TIMER,
+  SENSOR_COUNT,
+};
+
+// One read of the poll cycle, planned at setup from the configured sensors
+struct GenvexRead {
+  uint8_t function;
+  uint16_t start;
+  uint16_t count;
+};
+
+// A write waiting for a free bus slot, only the latest value per register is kept
+struct GenvexWrite {
+  uint16_t address;
+  uint16_t value;
+  uint8_t attempts;
+};
+
+static const uint8_t MAX_WRITES = 4;
+
+// When a decoded value is published: when it moved more than deadband from the last published value (in % of it
+// when relative) and min_interval ms passed since then, or when heartbeat ms passed without a publish. A negative
+// deadband publishes every value.
+struct PublishPolicy {
+  float deadband{-1};
+  bool relative{false};
+  uint32_t min_interval{0};
+  uint32_t heartbeat{0};
+};
+
 class Genvex : public PollingComponent, public modbus::ModbusDevice {
  public:
-  void set_temp_t1_sensor(sensor::Sensor * temp_t1_sensor) { temp_t1_sensor_ = temp_t1_sensor; }
-  void set_temp_t2_sensor(sensor::Sensor * temp_t2_sensor) { temp_t2_sensor_ = temp_t2_sensor; }
-  void set_temp_t3_sensor(sensor::Sensor * temp_t3_sensor) { temp_t3_sensor_ = temp_t3_sensor; }
-  void set_temp_t4_sensor(sensor::Sensor * temp_t4_sensor) { temp_t4_sensor_ = temp_t4_sensor; }
-  void set_temp_t5_sensor(sensor::Sensor * temp_t5_sensor) { temp_t5_sensor_ = temp_t5_sensor; }
-  void set_temp_t6_sensor(sensor::Sensor * temp_t6_sensor) { temp_t6_sensor_ = temp_t6_sensor; }
-  void set_temp_t7_sensor(sensor::Sensor * temp_t7_sensor) { temp_t7_sensor_ = temp_t7_sensor; }
-  void set_temp_t8_sensor(sensor::Sensor * temp_t8_sensor) { temp_t8_sensor_ = temp_t8_sensor; }
-  void set_temp_t9_sensor(sensor::Sensor * temp_t9_sensor) { temp_t9_sensor_ = temp_t9_sensor; }
-  void set_temp_t2_panel_sensor(sensor::Sensor * temp_t2_panel_sensor) { temp_t2_panel_sensor_ = temp_t2_panel_sensor; }
-  void set_measured_humidity_sensor(sensor::Sensor *measured_humidity_sensor) { measured_humidity_sensor_ = measured_humidity_sensor; }
-  void set_humidity_calculated_setpoint_sensor(sensor::Sensor *humidity_calculated_setpoint_sensor) { humidity_calculated_setpoint_sensor_ = humidity_calculated_setpoint_sensor; }
-  void set_alarm_bit_sensor(sensor::Sensor *alarm_bit_sensor) { alarm_bit_sensor_ = alarm_bit_sensor; }
-  void set_inlet_fan_sensor(sensor::Sensor *inlet_fan_sensor) { inlet_fan_sensor_ = inlet_fan_sensor; }
-  void set_extract_fan_sensor(sensor::Sensor *extract_fan_sensor) { extract_fan_sensor_ = extract_fan_sensor; }
-  void set_bypass_sensor(sensor::Sensor *bypass_sensor) { bypass_sensor_ = bypass_sensor; }
-  void set_watervalve_sensor(sensor::Sensor *watervalve_sensor) { watervalve_sensor_ = watervalve_sensor; }
-  void set_humidity_fan_control_sensor(sensor::Sensor *humidity_fan_control_sensor) { humidity_fan_control_sensor_ = humidity_fan_control_sensor; }
-  void set_bypass_on_off_sensor(sensor::Sensor *bypass_on_off_sensor) { bypass_on_off_sensor_ = bypass_on_off_sensor; }
-  void set_target_temp_sensor(sensor::Sensor *target_temp_sensor) { target_temp_sensor_ = target_temp_sensor; }
-  void set_speed_mode_sensor(sensor::Sensor *speed_mode_sensor) { speed_mode_sensor_ = speed_mode_sensor; }
-  void set_heat_sensor(sensor::Sensor *heat_sensor) { heat_sensor_ = heat_sensor; }
-  void set_timer_sensor(sensor::Sensor *timer_sensor) { timer_sensor_ = timer_sensor; }
+  void set_sensor(uint8_t slot, sensor::Sensor *sensor) { sensors_[slot] = sensor; }
+  void set_sensor_mask(uint32_t mask) { sensor_mask_ = mask; }
+  void set_publish_policy(uint8_t slot, float deadband, bool relative, uint32_t min_interval, uint32_t heartbeat) {
+    policies_[slot] = {deadband, relative, min_interval, heartbeat};
+  }
+  void set_frame_gap(uint32_t frame_gap) { frame_gap_ = frame_gap; }
+  void set_max_block_size(uint16_t max_block_size) { max_block_size_ = max_block_size; }
+  void set_max_gap(uint16_t max_gap) { max_gap_ = max_gap; }
+  void set_overruns_sensor(sensor::Sensor *sensor) { overruns_sensor_ = sensor; }
+  void set_skipped_reads_sensor(sensor::Sensor *sensor) { skipped_reads_sensor_ = sensor; }
 
   void add_target_temp_callback(std::function<void(float)> &&callback);
   void add_fan_speed_callback(std::function<void(int)> &&callback);
   
+  void setup() override;
   void loop() override;
   void update() override;
 
@@ -49,34 +91,41 @@ class Genvex : public PollingComponent, public modbus::ModbusDevice {
 
  protected:
   int state_{0};
-  uint8_t CMD_FUNCTION_REG{0x04};
   bool waiting_{false};
   long last_send_{0};
+  // the next read goes out frame_gap_ ms after the previous reply
+  uint32_t last_reply_{0};
+  uint32_t frame_gap_{50};
+  // updates that came in while the previous poll cycle was still running
+  uint32_t overruns_{0};
+  // tries of the current read, and reads given up on after READ_ATTEMPTS tries
+  uint8_t read_attempts_{0};
+  uint32_t skipped_reads_{0};
+  sensor::Sensor *overruns_sensor_{nullptr};
+  sensor::Sensor *skipped_reads_sensor_{nullptr};
   bool waiting_for_write_ack_{false};
-  
-  sensor::Sensor *temp_t1_sensor_; 
-  sensor::Sensor *temp_t2_sensor_; 
-  sensor::Sensor *temp_t3_sensor_; 
-  sensor::Sensor *temp_t4_sensor_; 
-  sensor::Sensor *temp_t5_sensor_; 
-  sensor::Sensor *temp_t6_sensor_; 
-  sensor::Sensor *temp_t7_sensor_; 
-  sensor::Sensor *temp_t8_sensor_; 
-  sensor::Sensor *temp_t9_sensor_; 
-  sensor::Sensor *temp_t2_panel_sensor_;
-  sensor::Sensor *measured_humidity_sensor_;  
-  sensor::Sensor *humidity_calculated_setpoint_sensor_;
-  sensor::Sensor *alarm_bit_sensor_;
-  sensor::Sensor *inlet_fan_sensor_;
-  sensor::Sensor *extract_fan_sensor_;
-  sensor::Sensor *bypass_sensor_;
-  sensor::Sensor *watervalve_sensor_;
-  sensor::Sensor *humidity_fan_control_sensor_;
-  sensor::Sensor *bypass_on_off_sensor_;
-  sensor::Sensor *target_temp_sensor_;
-  sensor::Sensor *speed_mode_sensor_;
-  sensor::Sensor *heat_sensor_;
-  sensor::Sensor *timer_sensor_;
+  uint16_t write_address_{0};
+  uint16_t write_value_{0};
+  GenvexWrite writes_[MAX_WRITES];
+  uint8_t write_count_{0};
+
+  void queue_write_(uint16_t address, uint16_t value);
+  void remove_write_(uint8_t index);
+  void send_write_();
+
+  // configured sensors, bit n is sensors_[n]
+  uint32_t sensor_mask_{0};
+  sensor::Sensor *sensors_[SENSOR_COUNT]{};
+  PublishPolicy policies_[SENSOR_COUNT];
+  float published_[SENSOR_COUNT];
+  uint32_t last_publish_[SENSOR_COUNT]{};
+
+  bool should_publish_(uint8_t slot, float value, uint32_t now);
+  // reads of one poll cycle, state_ n sends reads_[n - 1]
+  GenvexRead reads_[SENSOR_COUNT];
+  uint8_t read_count_{0};
+  uint16_t max_block_size_{16};
+  uint16_t max_gap_{8};
 
   CallbackManager<void(float)> target_temp_callback_;
   CallbackManager<void(int)> fan_speed_callback_;
@@ -19,10 +19,39 @@ from esphome.const import (
     DEVICE_CLASS_TEMPERATURE,
     DEVICE_CLASS_HUMIDITY,
     DEVICE_CLASS_EMPTY,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_TOTAL_INCREASING,
 )
 
 DEPENDENCIES = ['genvex']
 
+CONF_DEADBAND = "deadband"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_HEARTBEAT = "heartbeat"
+
+
+def deadband(value):
+    """An absolute deadband like 0.2, or one relative to the last published value like 5%."""
+    if isinstance(value, str) and value.strip().endswith('%'):
+        return (cv.positive_float(value.strip()[:-1]), True)
+    return (cv.positive_float(value), False)
+
+
+PUBLISH_POLICY_SCHEMA = cv.Schema({
+    cv.Optional(CONF_DEADBAND): deadband,
+    cv.Optional(CONF_MIN_INTERVAL): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_HEARTBEAT): cv.positive_time_period_milliseconds,
+})
+
+
+def genvex_sensor_schema(*args):
+    return sensor.sensor_schema(*args).extend(PUBLISH_POLICY_SCHEMA)
+
+
+COUNTER_SCHEMA = sensor.sensor_schema(accuracy_decimals=0, state_class=STATE_CLASS_TOTAL_INCREASING,
+                                      entity_category=ENTITY_CATEGORY_DIAGNOSTIC)
+
+
 CONF_TEMP_T1 = "temp_t1"
 CONF_TEMP_T2 = "temp_t2"
 CONF_TEMP_T3 = "temp_t3"
@@ -46,128 +75,85 @@ CONF_TARGET_TEMP = "target_temp"
 CONF_SPEED_MODE = "speed_mode"
 CONF_HEAT = "heat"
 CONF_TIMER = "timer"
+CONF_OVERRUNS = "overruns"
+CONF_SKIPPED_READS = "skipped_reads"
+
+# Sensor slot of each option, in the order of the GenvexSensor enum
+SENSORS = [
+    CONF_TEMP_T1,
+    CONF_TEMP_T2,
+    CONF_TEMP_T3,
+    CONF_TEMP_T4,
+    CONF_TEMP_T5,
+    CONF_TEMP_T6,
+    CONF_TEMP_T7,
+    CONF_TEMP_T8,
+    CONF_TEMP_T9,
+    CONF_TEMP_T2_PANEL,
+    CONF_MEASURED_HUMIDITY,
+    CONF_HUMIDITY_CALCULATED_SETPOINT,
+    CONF_ALARM_BIT,
+    CONF_INLET_FAN,
+    CONF_EXTRACT_FAN,
+    CONF_BYPASS,
+    CONF_WATERVALVE,
+    CONF_HUMIDITY_FAN_CONTROL,
+    CONF_BYPASS_ON_OFF,
+    CONF_TARGET_TEMP,
+    CONF_SPEED_MODE,
+    CONF_HEAT,
+    CONF_TIMER,
+]
 
 CONFIG_SCHEMA = cv.Schema({
     cv.GenerateID(CONF_GENVEX_ID): cv.use_id(Genvex),
-    cv.Required(CONF_TEMP_T1): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T2): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T3): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T4): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T5): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T6): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T7): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T8): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T9): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_TEMP_T2_PANEL): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Optional(CONF_MEASURED_HUMIDITY): sensor.sensor_schema(UNIT_PERCENT, ICON_WATER_PERCENT, 1, DEVICE_CLASS_HUMIDITY),
-    cv.Optional(CONF_HUMIDITY_CALCULATED_SETPOINT): sensor.sensor_schema(UNIT_PERCENT, ICON_WATER_PERCENT, 1, DEVICE_CLASS_HUMIDITY),
-    cv.Optional(CONF_ALARM_BIT): sensor.sensor_schema(UNIT_EMPTY, ICON_EMPTY, 1, DEVICE_CLASS_EMPTY),
-    cv.Optional(CONF_INLET_FAN): sensor.sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
-    cv.Optional(CONF_EXTRACT_FAN): sensor.sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
-    cv.Optional(CONF_BYPASS): sensor.sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
-    cv.Optional(CONF_WATERVALVE): sensor.sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
-    cv.Optional(CONF_HUMIDITY_FAN_CONTROL): sensor.sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
-    cv.Optional(CONF_BYPASS_ON_OFF): sensor.sensor_schema(UNIT_EMPTY, ICON_CHECK_CIRCLE_OUTLINE, 1, DEVICE_CLASS_EMPTY),
-    cv.Required(CONF_TARGET_TEMP): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
-    cv.Required(CONF_SPEED_MODE): sensor.sensor_schema(UNIT_EMPTY, ICON_GAUGE, 1, DEVICE_CLASS_EMPTY),
-    cv.Optional(CONF_HEAT): sensor.sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_EMPTY),
-    cv.Optional(CONF_TIMER): sensor.sensor_schema(UNIT_EMPTY, ICON_GAUGE, 1, DEVICE_CLASS_EMPTY)
+    cv.Required(CONF_TEMP_T1): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T2): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T3): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T4): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T5): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T6): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T7): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T8): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T9): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_TEMP_T2_PANEL): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Optional(CONF_MEASURED_HUMIDITY): genvex_sensor_schema(UNIT_PERCENT, ICON_WATER_PERCENT, 1, DEVICE_CLASS_HUMIDITY),
+    cv.Optional(CONF_HUMIDITY_CALCULATED_SETPOINT): genvex_sensor_schema(UNIT_PERCENT, ICON_WATER_PERCENT, 1, DEVICE_CLASS_HUMIDITY),
+    cv.Optional(CONF_ALARM_BIT): genvex_sensor_schema(UNIT_EMPTY, ICON_EMPTY, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_INLET_FAN): genvex_sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_EXTRACT_FAN): genvex_sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_BYPASS): genvex_sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_WATERVALVE): genvex_sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_HUMIDITY_FAN_CONTROL): genvex_sensor_schema(UNIT_PERCENT, ICON_PERCENT, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_BYPASS_ON_OFF): genvex_sensor_schema(UNIT_EMPTY, ICON_CHECK_CIRCLE_OUTLINE, 1, DEVICE_CLASS_EMPTY),
+    cv.Required(CONF_TARGET_TEMP): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_TEMPERATURE),
+    cv.Required(CONF_SPEED_MODE): genvex_sensor_schema(UNIT_EMPTY, ICON_GAUGE, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_HEAT): genvex_sensor_schema(UNIT_CELSIUS, ICON_THERMOMETER, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_TIMER): genvex_sensor_schema(UNIT_EMPTY, ICON_GAUGE, 1, DEVICE_CLASS_EMPTY),
+    cv.Optional(CONF_OVERRUNS): COUNTER_SCHEMA,
+    cv.Optional(CONF_SKIPPED_READS): COUNTER_SCHEMA,
 }).extend(cv.polling_component_schema('60s'))
 
 
 def to_code(config):
     genvex = yield cg.get_variable(config[CONF_GENVEX_ID])
 
-    if CONF_TEMP_T1 in config:
-        conf = config[CONF_TEMP_T1]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t1_sensor(sens))
-    if CONF_TEMP_T2 in config:
-        conf = config[CONF_TEMP_T2]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t2_sensor(sens))
-    if CONF_TEMP_T3 in config:
-        conf = config[CONF_TEMP_T3]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t3_sensor(sens))
-    if CONF_TEMP_T4 in config:
-        conf = config[CONF_TEMP_T4]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t4_sensor(sens))
-    if CONF_TEMP_T5 in config:
-        conf = config[CONF_TEMP_T5]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t5_sensor(sens))
-    if CONF_TEMP_T6 in config:
-        conf = config[CONF_TEMP_T6]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t6_sensor(sens))
-    if CONF_TEMP_T7 in config:
-        conf = config[CONF_TEMP_T7]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t7_sensor(sens))
-    if CONF_TEMP_T8 in config:
-        conf = config[CONF_TEMP_T8]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t8_sensor(sens))
-    if CONF_TEMP_T9 in config:
-        conf = config[CONF_TEMP_T9]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t9_sensor(sens))
-    if CONF_TEMP_T2_PANEL in config:
-        conf = config[CONF_TEMP_T2_PANEL]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_temp_t2_panel_sensor(sens))
-    if CONF_MEASURED_HUMIDITY in config:
-        conf = config[CONF_MEASURED_HUMIDITY]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_measured_humidity_sensor(sens))
-    if CONF_HUMIDITY_CALCULATED_SETPOINT in config:
-        conf = config[CONF_HUMIDITY_CALCULATED_SETPOINT]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_humidity_calculated_setpoint_sensor(sens))
-    if CONF_ALARM_BIT in config:
-        conf = config[CONF_ALARM_BIT]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_alarm_bit_sensor(sens))
-    if CONF_INLET_FAN in config:
-        conf = config[CONF_INLET_FAN]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_inlet_fan_sensor(sens))
-    if CONF_EXTRACT_FAN in config:
-        conf = config[CONF_EXTRACT_FAN]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_extract_fan_sensor(sens))
-    if CONF_BYPASS in config:
-        conf = config[CONF_BYPASS]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_bypass_sensor(sens))
-    if CONF_WATERVALVE in config:
-        conf = config[CONF_WATERVALVE]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_watervalve_sensor(sens))
-    if CONF_HUMIDITY_FAN_CONTROL in config:
-        conf = config[CONF_HUMIDITY_FAN_CONTROL]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_humidity_fan_control_sensor(sens))
-    if CONF_BYPASS_ON_OFF in config:
-        conf = config[CONF_BYPASS_ON_OFF]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_bypass_on_off_sensor(sens))
-    if CONF_TARGET_TEMP in config:
-        conf = config[CONF_TARGET_TEMP]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_target_temp_sensor(sens))
-    if CONF_SPEED_MODE in config:
-        conf = config[CONF_SPEED_MODE]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_speed_mode_sensor(sens))
-    if CONF_HEAT in config:
-        conf = config[CONF_HEAT]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_heat_sensor(sens))
-    if CONF_TIMER in config:
-        conf = config[CONF_TIMER]
-        sens = yield sensor.new_sensor(conf)
-        cg.add(genvex.set_timer_sensor(sens))          
-        
+    mask = 0
+    for slot, key in enumerate(SENSORS):
+        if key in config:
+            sens = yield sensor.new_sensor(config[key])
+            cg.add(genvex.set_sensor(slot, sens))
+            # without a publish policy every decoded value is published
+            conf = config[key]
+            if any(k in conf for k in (CONF_DEADBAND, CONF_MIN_INTERVAL, CONF_HEARTBEAT)):
+                band, relative = conf.get(CONF_DEADBAND, (0.0, False))
+                cg.add(genvex.set_publish_policy(slot, band, relative, conf.get(CONF_MIN_INTERVAL, 0),
+                                                 conf.get(CONF_HEARTBEAT, 0)))
+            mask |= 1 << slot
+    cg.add(genvex.set_sensor_mask(mask))
+
+    # diagnostics of the poll cycle, not read from the unit
+    for key in [CONF_OVERRUNS, CONF_SKIPPED_READS]:
+        if key in config:
+            sens = yield sensor.new_sensor(config[key])
+            cg.add(getattr(genvex, f'set_{key}_sensor')(sens))
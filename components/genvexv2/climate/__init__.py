@@ -6,10 +6,13 @@ from esphome.const import (
     CONF_ID
 )
 
+AUTO_LOAD = ['register_climate']
+
 CONF_TARGET_TEMP = "target_temp_sensor_id"
 CONF_CURRENT_TEMP = "current_temp_sensor_id"
 CONF_FAN_SPEED = "fan_speed_sensor_id"
 #CONF_MODE = "mode_select_id"
+CONF_PUBLISH_WINDOW = "publish_window"
 
 genvexv2_ns = cg.esphome_ns.namespace('genvexv2')
 Genvexv2Climate = genvexv2_ns.class_('Genvexv2Climate', climate.Climate, cg.Component)
@@ -21,12 +24,14 @@ CONFIG_SCHEMA = climate.CLIMATE_SCHEMA.extend({
     cv.Required(CONF_CURRENT_TEMP): cv.use_id(sensor.Sensor),
     cv.Required(CONF_FAN_SPEED): cv.use_id(number.Number),
     #cv.Required(CONF_MODE): cv.use_id(select.Select)
+    cv.Optional(CONF_PUBLISH_WINDOW, default='0ms'): cv.positive_time_period_milliseconds,
 }).extend(cv.COMPONENT_SCHEMA)
  
 def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     yield cg.register_component(var, config)
     yield climate.register_climate(var, config)
+    cg.add(var.set_publish_window(config[CONF_PUBLISH_WINDOW]))
 
     number_set_temp = yield cg.get_variable(config[CONF_TARGET_TEMP])
     cg.add(var.set_temp_setpoint_number(number_set_temp))
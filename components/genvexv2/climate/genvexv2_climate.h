@@ -1,61 +1,43 @@
 #pragma once
 
 #include "esphome/core/component.h"
-#include "esphome/components/climate/climate.h"
-#include "esphome/components/sensor/sensor.h"
-#include "esphome/components/number/number.h"
-#include "esphome/components/select/select.h"
+#include "esphome/components/register_climate/register_climate.h"
 
 namespace esphome {
 namespace genvexv2 {
-class Genvexv2Climate : public climate::Climate, public Component {
+
+using register_climate::FanModeMapping;
+using register_climate::ModeMapping;
+
+class Genvexv2Climate : public register_climate::RegisterClimate<Genvexv2Climate> {
 public:
 
   Genvexv2Climate() {}
 
-  void setup() override;
   void dump_config() override;
 
-  void set_current_temp_sensor(sensor::Sensor *sensor) {
-    this->current_temp_sensor_ = sensor;
-  }
-
-  void set_temp_setpoint_number(number::Number *number) {
-    this->temp_setpoint_number_ = number;
-  }
-
-  void set_fan_speed_number(number::Number *number) {
-    this->fan_speed_number_ = number;
-  }
-
-  //void set_mode_select(select::Select *select) {
-  //  this->mode_select_ = select;
-  //}
+  /// The unit has no mode register, fan speed 0 is off and any other speed is auto
+  static constexpr std::array<ModeMapping, 2> MODES{{
+    {0, climate::CLIMATE_MODE_OFF},
+    {2, climate::CLIMATE_MODE_AUTO},
+  }};
+  static constexpr climate::ClimateMode FALLBACK_MODE = climate::CLIMATE_MODE_AUTO;
+
+  /// Fan speed 0 is off, 1-4 are shown as custom fan modes
+  static constexpr std::array<FanModeMapping, 5> FAN_MODES{{
+    {0, climate::CLIMATE_FAN_OFF, nullptr},
+    {1, climate::CLIMATE_FAN_ON, "1"},
+    {2, climate::CLIMATE_FAN_ON, "2"},
+    {3, climate::CLIMATE_FAN_ON, "3"},
+    {4, climate::CLIMATE_FAN_ON, "4"},
+  }};
 
 protected:
-  /// Override control to change settings of the climate device.
-  void control(const climate::ClimateCall& call) override;
-
-  /// Return the traits of this controller.
-  climate::ClimateTraits traits() override;
-
-  /// The sensor used for getting the current temperature
-  sensor::Sensor *current_temp_sensor_{ nullptr };
-
-  /// The number component used for getting the temperature setpoint
-  number::Number *temp_setpoint_number_{ nullptr };
-
-  /// The number component used for getting fan speed
-  number::Number *fan_speed_number_{ nullptr };
-
-  /// The select component used for getting the operation mode
-  //select::Select *mode_select_{ nullptr };
-
-private:
+  friend class register_climate::RegisterClimate<Genvexv2Climate>;
 
-  void genvexv2fanspeed_to_fanmode(const int state);
-  int climatemode_to_genvexv2operationmode(const climate::ClimateMode mode);
-  void genvexv2modetext_to_climatemode(const std::string& genvexv2_mode);
+  void build_traits(climate::ClimateTraits &traits);
+  void write_mode(climate::ClimateMode mode);
+  void on_fan_speed(int speed);
 };
 } // namespace genvexv2
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
@@ -34,7 +34,8 @@ CONFIG_SCHEMA = select.SELECT_SCHEMA.extend({
     cv.Optional(CONF_OFFSET, default=0): cv.positive_int,
     cv.Optional(CONF_BYTE_OFFSET): cv.positive_int,
     #cv.Optional(CONF_BITMASK, default=0xFFFFFFFF): cv.hex_uint32_t,
-    cv.Optional(CONF_VALUE_TYPE, default="U_WORD"): cv.enum(SENSOR_VALUE_TYPE),
+    # the register value is the option index, read as a plain 16 bit word
+    cv.Optional(CONF_VALUE_TYPE, default="U_WORD"): cv.All(cv.one_of("U_WORD", upper=True), cv.enum(SENSOR_VALUE_TYPE)),
     #cv.Optional(CONF_REGISTER_COUNT, default=0): cv.positive_int,
     cv.Optional(CONF_SKIP_UPDATES, default=0): cv.positive_int,
     cv.Optional(CONF_FORCE_NEW_RANGE, default=False): cv.boolean,
@@ -6,52 +6,108 @@ namespace genvexv2 {
 
 static const char *TAG = "genvexv2.select";
 
-using modbus_controller::ModbusCommandItem;
+// How long to wait for the device to acknowledge a write before falling back to the polled value
+static const uint32_t WRITE_ACK_TIMEOUT = 5000;
+
 using modbus_controller::ModbusRegisterType;
 
-void Genvexv2Select::parse_and_publish(const std::vector<uint8_t> &data) {
-  union {
-    float float_value;
-    uint32_t raw;
-  } raw_to_float;
+void Genvexv2Select::setup() {
+  this->options_ = traits.get_options();
 
-  float received_value = payload_to_float(data, *this);
-  ESP_LOGD(TAG, "Genvexv2 Select index: %f", received_value);
+  this->write_cmd_ = ModbusCommandItem::create_write_single_command(modbus_controller_, this->start_address, 0);
+  this->write_cmd_.on_data_func =
+  [this](ModbusRegisterType register_type, uint16_t start_address, const std::vector<uint8_t> &data) {
+    // gets called when the write command is ack'd from the device
+    modbus_controller_->on_write_register_response(register_type, start_address, data);
+    this->on_write_ack_(data);
+  };
+}
 
-  auto options = traits.get_options();
+void Genvexv2Select::parse_and_publish(const std::vector<uint8_t> &data) {
+  if(data.size() < this->offset + 2u)
+    return;
 
-  if(received_value < options.size()) {
-    auto select_value = options[received_value];
-    ESP_LOGD(TAG, "Select new state : %s", select_value.c_str());
-    this->publish_state(select_value);
+  uint16_t index = modbus_controller::get_data<uint16_t>(data, this->offset);
+  if(index >= options_.size()) {
+    ESP_LOGW(TAG, "Genvexv2 Select index %u out of range", index);
+    return;
   }
+  device_index_ = index;
+  // while a write is outstanding the poll still shows the old value, the ack settles the state
+  if(write_index_ < 0 && pending_index_ < 0)
+    this->publish_index_(index);
+}
+
+void Genvexv2Select::publish_index_(int index) {
+  // the poll reads the register every cycle, only a new index is published
+  if(index < 0 || index == published_index_)
+    return;
+
+  published_index_ = index;
+  ESP_LOGD(TAG, "Select new state : %s", options_[index].c_str());
+  this->publish_state(options_[index]);
 }
 
 void Genvexv2Select::control(const std::string &value) {
   ESP_LOGD(TAG, "Genvexv2 Select state: %s", value.c_str());
 
-  auto options = traits.get_options();
-
-  for(auto i = 0; i<options.size(); ++i) {
-    if(options[i] == value) {
-      ESP_LOGD(TAG, "WRITING INDEX: %d", i);
-      std::vector<uint16_t> data = modbus_controller::float_to_payload(i, modbus_controller::SensorValueType::U_WORD);
-      uint16_t speed = i;
-      ESP_LOGD(TAG, "UINT16_t speed: %i", speed);
-      //auto write_cmd = ModbusCommandItem::create_write_multiple_command(modbus_controller_, this->start_address + this->offset, this->register_count, data);
-      auto write_cmd = ModbusCommandItem::create_write_single_command(modbus_controller_, this->start_address, speed);
-
-      // publish new value
-      write_cmd.on_data_func = 
-      [this, write_cmd, value](ModbusRegisterType register_type, uint16_t start_address, const std::vector<uint8_t> &data) {
-        // gets called when the write command is ack'd from the device
-        modbus_controller_->on_write_register_response(write_cmd.register_type, start_address, data);
-        this->publish_state(value);
-      };
-      modbus_controller_->queue_command(write_cmd);
+  for(size_t i = 0; i < options_.size(); ++i) {
+    if(options_[i] == value) {
+      int index = i;
+      // optimistic, reconciled with the device when the write is acknowledged or times out
+      this->publish_index_(index);
+      if(write_index_ >= 0) {
+        // only the last selection made while a write is on the bus is sent after it
+        pending_index_ = index == write_index_ ? -1 : index;
+        return;
+      }
+      if(index != device_index_)
+        this->send_write_(index);
+      return;
+    }
+  }
+}
+
+void Genvexv2Select::send_write_(int index) {
+  ESP_LOGD(TAG, "WRITING INDEX: %d", index);
+  this->write_index_ = index;
+  this->write_cmd_.payload[0] = index >> 8;
+  this->write_cmd_.payload[1] = index & 0xFF;
+  modbus_controller_->queue_command(write_cmd_);
+
+  this->set_timeout("write", WRITE_ACK_TIMEOUT, [this]() {
+    ESP_LOGW(TAG, "Write of index %d to register %u not acknowledged", write_index_, this->start_address);
+    this->finish_write_();
+  });
+}
+
+void Genvexv2Select::on_write_ack_(const std::vector<uint8_t> &data) {
+  if(write_index_ < 0)
+    return; // late ack of a write that already timed out, the next poll brings the state
+
+  // the reply echoes the register and the value written, a late ack of an earlier write carries another value
+  int index = data.size() >= 4 ? (data[2] << 8 | data[3]) : write_index_;
+  if(index != write_index_) {
+    ESP_LOGW(TAG, "Ack of index %d doesn't match the write of index %d, ignored", index, write_index_);
+    return;
+  }
+  device_index_ = index;
+  this->cancel_timeout("write");
+  this->finish_write_();
+}
+
+void Genvexv2Select::finish_write_() {
+  write_index_ = -1;
+  if(pending_index_ >= 0) {
+    int index = pending_index_;
+    pending_index_ = -1;
+    if(index != device_index_) {
+      this->send_write_(index);
+      return;
     }
   }
+  this->publish_index_(device_index_);
 }
 
 } // namespace genvexv2
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
@@ -7,6 +7,7 @@
 namespace esphome {
 namespace genvexv2 {
 
+using modbus_controller::ModbusCommandItem;
 using modbus_controller::ModbusController;
 using modbus_controller::SensorItem;
 using modbus_controller::SensorValueType;
@@ -27,6 +28,7 @@ public:
     this->force_new_range = force_new_range;
   };
 
+  void setup() override;
   void parse_and_publish(const std::vector<uint8_t> &data) override;
   void set_parent(ModbusController *modbus_controller) { this->modbus_controller_ = modbus_controller; }
 
@@ -34,6 +36,23 @@ protected:
   modbus_controller::ModbusController *modbus_controller_;
 
   void control(const std::string &value) override;
+  void publish_index_(int index);
+  void send_write_(int index);
+  void on_write_ack_(const std::vector<uint8_t> &data);
+  void finish_write_();
+
+  /// The options by register value, copied once from the traits at setup
+  std::vector<std::string> options_;
+  /// Index of the last published option, -1 before the first one
+  int published_index_{-1};
+  /// Index last read from or acknowledged by the device
+  int device_index_{-1};
+  /// Index of the write on the bus, -1 when none is in flight
+  int write_index_{-1};
+  /// Index to write once the one in flight is done, later selections replace it
+  int pending_index_{-1};
+  /// Single register write to start_address, only the value is filled in per write
+  ModbusCommandItem write_cmd_;
 };
 } // namespace genvexv2
 } // namespace esphome
\ No newline at end of file
@@ -0,0 +1,80 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import (
+    CONF_ID,
+    CONF_POWER,
+    CONF_ENERGY,
+    DEVICE_CLASS_POWER,
+    DEVICE_CLASS_ENERGY,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_PERCENT,
+    UNIT_WATT,
+    UNIT_KILOWATT_HOURS,
+    ICON_PERCENT,
+)
+
+AUTO_LOAD = ['sensor']
+MULTI_CONF = True
+
+heat_recovery_ns = cg.esphome_ns.namespace('heat_recovery')
+HeatRecovery = heat_recovery_ns.class_('HeatRecovery', cg.Component)
+
+CONF_SUPPLY_TEMPERATURE = 'supply_temperature'
+CONF_OUTDOOR_TEMPERATURE = 'outdoor_temperature'
+CONF_EXTRACT_TEMPERATURE = 'extract_temperature'
+CONF_FAN_SPEED = 'fan_speed'
+CONF_NOMINAL_AIRFLOW = 'nominal_airflow'
+CONF_MIN_TEMPERATURE_DIFFERENCE = 'min_temperature_difference'
+CONF_MIN_INTERVAL = 'min_interval'
+CONF_EFFICIENCY = 'efficiency'
+
+
+def validate_airflow(config):
+    if (CONF_POWER in config or CONF_ENERGY in config) and CONF_NOMINAL_AIRFLOW not in config:
+        raise cv.Invalid(f"{CONF_NOMINAL_AIRFLOW} is needed for {CONF_POWER} and {CONF_ENERGY}")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(cv.Schema({
+    cv.GenerateID(): cv.declare_id(HeatRecovery),
+    cv.Required(CONF_SUPPLY_TEMPERATURE): cv.use_id(sensor.Sensor),
+    cv.Required(CONF_OUTDOOR_TEMPERATURE): cv.use_id(sensor.Sensor),
+    cv.Required(CONF_EXTRACT_TEMPERATURE): cv.use_id(sensor.Sensor),
+    cv.Optional(CONF_FAN_SPEED): cv.use_id(sensor.Sensor),
+    cv.Optional(CONF_NOMINAL_AIRFLOW): cv.positive_float,
+    cv.Optional(CONF_MIN_TEMPERATURE_DIFFERENCE, default=1.0): cv.positive_float,
+    cv.Optional(CONF_MIN_INTERVAL, default='0s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_EFFICIENCY): sensor.sensor_schema(unit_of_measurement=UNIT_PERCENT, icon=ICON_PERCENT,
+                                                       accuracy_decimals=1, state_class=STATE_CLASS_MEASUREMENT),
+    cv.Optional(CONF_POWER): sensor.sensor_schema(unit_of_measurement=UNIT_WATT, accuracy_decimals=0,
+                                                  device_class=DEVICE_CLASS_POWER,
+                                                  state_class=STATE_CLASS_MEASUREMENT),
+    cv.Optional(CONF_ENERGY): sensor.sensor_schema(unit_of_measurement=UNIT_KILOWATT_HOURS, accuracy_decimals=3,
+                                                   device_class=DEVICE_CLASS_ENERGY,
+                                                   state_class=STATE_CLASS_TOTAL_INCREASING),
+}).extend(cv.COMPONENT_SCHEMA), validate_airflow)
+
+
+def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    yield cg.register_component(var, config)
+
+    sens = yield cg.get_variable(config[CONF_SUPPLY_TEMPERATURE])
+    cg.add(var.set_supply_sensor(sens))
+    sens = yield cg.get_variable(config[CONF_OUTDOOR_TEMPERATURE])
+    cg.add(var.set_outdoor_sensor(sens))
+    sens = yield cg.get_variable(config[CONF_EXTRACT_TEMPERATURE])
+    cg.add(var.set_extract_sensor(sens))
+    if CONF_FAN_SPEED in config:
+        sens = yield cg.get_variable(config[CONF_FAN_SPEED])
+        cg.add(var.set_fan_speed_sensor(sens))
+    if CONF_NOMINAL_AIRFLOW in config:
+        cg.add(var.set_nominal_airflow(config[CONF_NOMINAL_AIRFLOW]))
+    cg.add(var.set_min_temperature_difference(config[CONF_MIN_TEMPERATURE_DIFFERENCE]))
+    cg.add(var.set_min_interval(config[CONF_MIN_INTERVAL]))
+    for key in [CONF_EFFICIENCY, CONF_POWER, CONF_ENERGY]:
+        if key in config:
+            sens = yield sensor.new_sensor(config[key])
+            cg.add(getattr(var, f'set_{key}_sensor')(sens))
@@ -0,0 +1,72 @@
+#include "heat_recovery.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace heat_recovery {
+
+static const char *TAG = "heat_recovery";
+
+// Volumetric heat capacity of air in Wh/(m³·K): 1.2 kg/m³ times 1005 J/(kg·K)
+static const float AIR_HEAT_CAPACITY = 1.2f * 1005.0f / 3600.0f;
+
+void HeatRecovery::setup() {
+  auto callback = [this](float) { update_(millis()); };
+  supply_sensor_->add_on_state_callback(callback);
+  outdoor_sensor_->add_on_state_callback(callback);
+  extract_sensor_->add_on_state_callback(callback);
+  if (fan_speed_sensor_ != nullptr)
+    fan_speed_sensor_->add_on_state_callback(callback);
+}
+
+// Runs whenever one of the inputs is published. The energy is integrated with the power computed from the previous
+// inputs, up to now, so it is exact for inputs that hold their value until the next publish.
+void HeatRecovery::update_(uint32_t now) {
+  if (!std::isnan(power_) && power_ > 0)
+    energy_ += power_ * (now - last_update_) / 3600000.0 / 1000.0;
+  last_update_ = now;
+
+  float supply = supply_sensor_->state;
+  float outdoor = outdoor_sensor_->state;
+  float extract = extract_sensor_->state;
+  // with extract and outdoor air at about the same temperature there is nothing to recover and the ratio is noise
+  float span = extract - outdoor;
+  if (std::isnan(supply) || std::isnan(span) || fabsf(span) < min_temperature_difference_)
+    efficiency_ = NAN;
+  else
+    efficiency_ = 100 * (supply - outdoor) / span;
+  float airflow = nominal_airflow_;
+  if (fan_speed_sensor_ != nullptr)
+    airflow *= fan_speed_sensor_->state / 100;
+  power_ = AIR_HEAT_CAPACITY * airflow * (supply - outdoor);
+  dirty_ = true;
+}
+
+// The inputs read in one reply are published back to back, the figures are published once after all of them
+void HeatRecovery::loop() {
+  uint32_t now = millis();
+  if (!dirty_ || (published_ && now - last_publish_ < min_interval_))
+    return;
+  dirty_ = false;
+  published_ = true;
+  last_publish_ = now;
+  if (efficiency_sensor_ != nullptr && !std::isnan(efficiency_))
+    efficiency_sensor_->publish_state(efficiency_);
+  if (power_sensor_ != nullptr && !std::isnan(power_))
+    power_sensor_->publish_state(power_);
+  if (energy_sensor_ != nullptr)
+    energy_sensor_->publish_state(energy_);
+}
+
+void HeatRecovery::dump_config() {
+  ESP_LOGCONFIG(TAG, "Heat recovery:");
+  ESP_LOGCONFIG(TAG, "  Nominal airflow: %.0f m³/h", nominal_airflow_);
+  ESP_LOGCONFIG(TAG, "  Min temperature difference: %.1f °C", min_temperature_difference_);
+  ESP_LOGCONFIG(TAG, "  Min interval: %u ms", min_interval_);
+  LOG_SENSOR("  ", "Efficiency", efficiency_sensor_);
+  LOG_SENSOR("  ", "Power", power_sensor_);
+  LOG_SENSOR("  ", "Energy", energy_sensor_);
+}
+
+}  // namespace heat_recovery
+}  // namespace esphome
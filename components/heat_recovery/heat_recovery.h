@@ -0,0 +1,54 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+
+namespace esphome {
+namespace heat_recovery {
+
+// Heat recovery figures of a ventilation unit, derived from its temperature sensors as they are published. Works
+// with any driver that exposes the supply, outdoor and extract air temperatures as sensors.
+class HeatRecovery : public Component {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+
+  void set_supply_sensor(sensor::Sensor *sensor) { supply_sensor_ = sensor; }
+  void set_outdoor_sensor(sensor::Sensor *sensor) { outdoor_sensor_ = sensor; }
+  void set_extract_sensor(sensor::Sensor *sensor) { extract_sensor_ = sensor; }
+  void set_fan_speed_sensor(sensor::Sensor *sensor) { fan_speed_sensor_ = sensor; }
+  void set_nominal_airflow(float airflow) { nominal_airflow_ = airflow; }
+  void set_min_temperature_difference(float difference) { min_temperature_difference_ = difference; }
+  void set_min_interval(uint32_t interval) { min_interval_ = interval; }
+  void set_efficiency_sensor(sensor::Sensor *sensor) { efficiency_sensor_ = sensor; }
+  void set_power_sensor(sensor::Sensor *sensor) { power_sensor_ = sensor; }
+  void set_energy_sensor(sensor::Sensor *sensor) { energy_sensor_ = sensor; }
+
+ protected:
+  void update_(uint32_t now);
+
+  sensor::Sensor *supply_sensor_{nullptr};
+  sensor::Sensor *outdoor_sensor_{nullptr};
+  sensor::Sensor *extract_sensor_{nullptr};
+  sensor::Sensor *fan_speed_sensor_{nullptr};
+  float nominal_airflow_{0};
+  float min_temperature_difference_{1.0};
+  uint32_t min_interval_{0};
+
+  float efficiency_{NAN};
+  float power_{NAN};
+  double energy_{0};
+  uint32_t last_update_{0};
+  uint32_t last_publish_{0};
+  bool published_{false};
+  // set when an input changed the figures, they are published from loop()
+  bool dirty_{false};
+
+  sensor::Sensor *efficiency_sensor_{nullptr};
+  sensor::Sensor *power_sensor_{nullptr};
+  sensor::Sensor *energy_sensor_{nullptr};
+};
+
+}  // namespace heat_recovery
+}  // namespace esphome
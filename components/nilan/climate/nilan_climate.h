@@ -1,58 +1,50 @@
 #pragma once
 
 #include "esphome/core/component.h"
-#include "esphome/components/climate/climate.h"
-#include "esphome/components/sensor/sensor.h"
-#include "esphome/components/number/number.h"
+#include "esphome/components/register_climate/register_climate.h"
 #include "esphome/components/select/select.h"
 
 namespace esphome {
 namespace nilan {
-class NilanClimate : public climate::Climate, public Component {
-public:
-  void setup() override;
-  void dump_config() override;
 
-  void set_current_temp_sensor(sensor::Sensor *sensor) {
-    this->current_temp_sensor_ = sensor;
-  }
+using register_climate::FanModeMapping;
+using register_climate::ModeMapping;
 
-  void set_temp_setpoint_number(number::Number *number) {
-    this->temp_setpoint_number_ = number;
-  }
-
-  void set_fan_speed_number(number::Number *number) {
-    this->fan_speed_number_ = number;
-  }
+class NilanClimate : public register_climate::RegisterClimate<NilanClimate> {
+public:
+  void dump_config() override;
 
   void set_mode_select(select::Select *select) {
     this->mode_select_ = select;
   }
 
-protected:
-  /// Override control to change settings of the climate device.
-  void control(const climate::ClimateCall& call) override;
-
-  /// Return the traits of this controller.
-  climate::ClimateTraits traits() override;
-
-  /// The sensor used for getting the current temperature
-  sensor::Sensor *current_temp_sensor_{ nullptr };
+  /// Operation mode select index to climate mode
+  static constexpr std::array<ModeMapping, 4> MODES{{
+    {0, climate::CLIMATE_MODE_OFF},
+    {1, climate::CLIMATE_MODE_HEAT},
+    {2, climate::CLIMATE_MODE_COOL},
+    {3, climate::CLIMATE_MODE_HEAT_COOL},
+  }};
+  static constexpr climate::ClimateMode FALLBACK_MODE = climate::CLIMATE_MODE_HEAT_COOL;
+
+  /// Fan speed 0 is off, 1-4 are shown as custom fan modes
+  static constexpr std::array<FanModeMapping, 5> FAN_MODES{{
+    {0, climate::CLIMATE_FAN_OFF, nullptr},
+    {1, climate::CLIMATE_FAN_ON, "1"},
+    {2, climate::CLIMATE_FAN_ON, "2"},
+    {3, climate::CLIMATE_FAN_ON, "3"},
+    {4, climate::CLIMATE_FAN_ON, "4"},
+  }};
 
-  /// The number component used for getting the temperature setpoint
-  number::Number *temp_setpoint_number_{ nullptr };
+protected:
+  friend class register_climate::RegisterClimate<NilanClimate>;
 
-  /// The number component used for getting fan speed
-  number::Number *fan_speed_number_{ nullptr };
+  void build_traits(climate::ClimateTraits &traits);
+  void bind_mode_source();
+  void write_mode(climate::ClimateMode mode);
 
   /// The select component used for getting the operation mode
   select::Select *mode_select_{ nullptr };
-
-private:
-
-  void nilanfanspeed_to_fanmode(const int state);
-  int climatemode_to_nilanoperationmode(const climate::ClimateMode mode);
-  void nilanmodetext_to_climatemode(const size_t index);
 };
 } // namespace nilan
 } // namespace esphome
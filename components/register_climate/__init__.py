@@ -0,0 +1,4 @@
+import esphome.config_validation as cv
+
+# Header only climate base of the nilan, genvexv2, sentio and wavinahc9000v2 climates
+CONFIG_SCHEMA = cv.Schema({})
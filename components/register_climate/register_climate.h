@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "esphome/components/climate/climate.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/number/number.h"
+
+// Climate on top of the register entities of a device: a current temperature sensor, a setpoint number, an optional
+// fan speed number and a device specific mode source. A device derives from RegisterClimate<Device> and supplies
+//   static constexpr std::array<ModeMapping, N> MODES        register value to climate mode
+//   static constexpr climate::ClimateMode FALLBACK_MODE      mode of register values not in MODES
+//   static constexpr std::array<FanModeMapping, N> FAN_MODES fan speed to fan mode, the first entry is the fallback
+//   void build_traits(climate::ClimateTraits &traits)        visual limits and modes
+// and may shadow the other hooks below (bind_mode_source, write_mode, on_fan_speed, target_to_register).
+
+namespace esphome {
+namespace register_climate {
+
+static const char *const TAG = "register_climate";
+
+struct ModeMapping {
+  int value;
+  climate::ClimateMode mode;
+};
+
+// A fan speed shown as a standard fan mode, or as the custom fan mode custom when that is set
+struct FanModeMapping {
+  int value;
+  climate::ClimateFanMode fan_mode;
+  const char *custom;
+};
+
+template<typename Device> class RegisterClimate : public climate::Climate, public Component {
+public:
+  void setup() override {
+    current_temp_sensor_->add_on_state_callback([this](float state) {
+      this->current_temperature = state;
+      this->state_dirty_ = true;
+    });
+    temp_setpoint_number_->add_on_state_callback([this](float state) {
+      this->target_temperature = state;
+      this->state_dirty_ = true;
+    });
+    if (fan_speed_number_ != nullptr) {
+      fan_speed_number_->add_on_state_callback([this](float state) {
+        this->set_fan_speed_(state);
+        this->state_dirty_ = true;
+      });
+    }
+    this->device_()->bind_mode_source();
+
+    this->current_temperature = current_temp_sensor_->state;
+    this->target_temperature = temp_setpoint_number_->state;
+    if (fan_speed_number_ != nullptr)
+      this->set_fan_speed_(fan_speed_number_->state);
+  }
+
+  void loop() override {
+    // all callbacks of one poll cycle end up in a single state message
+    if (!state_dirty_ || millis() - last_publish_ < publish_window_)
+      return;
+    state_dirty_ = false;
+    if (published_ && !state_changed_())
+      return;
+
+    published_ = true;
+    published_current_temperature_ = this->current_temperature;
+    published_target_temperature_ = this->target_temperature;
+    published_mode_ = this->mode;
+    published_action_ = this->action;
+    published_fan_index_ = fan_index_;
+    last_publish_ = millis();
+    this->publish_state();
+  }
+
+  void set_publish_window(uint32_t window) { this->publish_window_ = window; }
+  void set_current_temp_sensor(sensor::Sensor *sensor) { this->current_temp_sensor_ = sensor; }
+  void set_temp_setpoint_number(number::Number *number) { this->temp_setpoint_number_ = number; }
+  void set_fan_speed_number(number::Number *number) { this->fan_speed_number_ = number; }
+
+  // Defaults of the device hooks
+  static constexpr std::array<FanModeMapping, 0> FAN_MODES{};
+  void bind_mode_source() {}
+  void write_mode(climate::ClimateMode /*mode*/) {}
+  void on_fan_speed(int /*speed*/) {}
+  float target_to_register(float target) const { return target; }
+
+protected:
+  climate::ClimateTraits traits() override {
+    climate::ClimateTraits traits;
+    for (const auto &fan : Device::FAN_MODES) {
+      if (fan.custom != nullptr)
+        traits.add_supported_custom_fan_mode(fan.custom);
+      else
+        traits.add_supported_fan_mode(fan.fan_mode);
+    }
+    this->device_()->build_traits(traits);
+    return traits;
+  }
+
+  void control(const climate::ClimateCall &call) override {
+    if (call.get_target_temperature().has_value()) {
+      this->target_temperature = *call.get_target_temperature();
+      float target = this->device_()->target_to_register(this->target_temperature);
+      ESP_LOGD(TAG, "Target temperature changed to: %f", target);
+      temp_setpoint_number_->make_call().set_value(target).perform();
+    }
+
+    if (call.get_mode().has_value()) {
+      this->mode = *call.get_mode();
+      this->device_()->write_mode(this->mode);
+    }
+
+    if (call.get_fan_mode().has_value()) {
+      for (size_t i = 0; i < Device::FAN_MODES.size(); i++) {
+        if (Device::FAN_MODES[i].custom == nullptr && Device::FAN_MODES[i].fan_mode == *call.get_fan_mode())
+          this->write_fan_index_(i);
+      }
+    }
+
+    if (call.get_custom_fan_mode().has_value()) {
+      const std::string &custom = *call.get_custom_fan_mode();
+      for (size_t i = 0; i < Device::FAN_MODES.size(); i++) {
+        if (Device::FAN_MODES[i].custom != nullptr && custom == Device::FAN_MODES[i].custom)
+          this->write_fan_index_(i);
+      }
+    }
+    this->state_dirty_ = true;
+  }
+
+  static climate::ClimateMode mode_from_register(int value) {
+    for (const auto &mapping : Device::MODES) {
+      if (mapping.value == value)
+        return mapping.mode;
+    }
+    return Device::FALLBACK_MODE;
+  }
+
+  // Register value of a mode, -1 when the device has none for it
+  static int mode_to_register(climate::ClimateMode mode) {
+    for (const auto &mapping : Device::MODES) {
+      if (mapping.mode == mode)
+        return mapping.value;
+    }
+    return -1;
+  }
+
+  // Shows and writes the fan speed of FAN_MODES[index]
+  void write_fan_index_(size_t index) {
+    this->set_fan_index_(index);
+    ESP_LOGD(TAG, "Fan speed set to: %d", Device::FAN_MODES[index].value);
+    fan_speed_number_->make_call().set_value(Device::FAN_MODES[index].value).perform();
+  }
+
+  // Shows and writes a fan speed, used by devices that switch modes through the fan speed
+  void write_fan_speed_(int speed) {
+    for (size_t i = 0; i < Device::FAN_MODES.size(); i++) {
+      if (Device::FAN_MODES[i].value == speed) {
+        this->write_fan_index_(i);
+        return;
+      }
+    }
+  }
+
+  void set_fan_speed_(float state) {
+    // a device without fan modes can still be given a fan speed number, there is nothing to show then
+    if (std::isnan(state) || Device::FAN_MODES.size() == 0)
+      return;
+    int speed = state;
+    size_t index = 0;
+    for (size_t i = 0; i < Device::FAN_MODES.size(); i++) {
+      if (Device::FAN_MODES[i].value == speed) {
+        index = i;
+        break;
+      }
+    }
+    this->set_fan_index_(index);
+    this->device_()->on_fan_speed(speed);
+  }
+
+  void set_fan_index_(size_t index) {
+    // the option strings only change with the fan speed, so they are only copied then
+    if ((int) index == fan_index_)
+      return;
+    fan_index_ = index;
+    const FanModeMapping &fan = Device::FAN_MODES[index];
+    if (fan.custom != nullptr) {
+      this->fan_mode.reset();
+      this->custom_fan_mode = std::string(fan.custom);
+    } else {
+      this->custom_fan_mode.reset();
+      this->fan_mode = fan.fan_mode;
+    }
+  }
+
+  bool state_changed_() const {
+    return !same_temperature_(this->current_temperature, published_current_temperature_) ||
+           !same_temperature_(this->target_temperature, published_target_temperature_) ||
+           this->mode != published_mode_ ||
+           this->action != published_action_ ||
+           fan_index_ != published_fan_index_;
+  }
+
+  static bool same_temperature_(float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); }
+
+  Device *device_() { return static_cast<Device *>(this); }
+
+  /// The sensor used for getting the current temperature
+  sensor::Sensor *current_temp_sensor_{ nullptr };
+
+  /// The number component used for getting the temperature setpoint
+  number::Number *temp_setpoint_number_{ nullptr };
+
+  /// The number component used for getting fan speed, not used by every device
+  number::Number *fan_speed_number_{ nullptr };
+
+  /// Index in FAN_MODES of the fan speed shown, -1 before the first one
+  int fan_index_{ -1 };
+
+  /// Set by the source entity callbacks, the state is published from loop()
+  bool state_dirty_{ false };
+  bool published_{ false };
+  uint32_t publish_window_{ 0 };
+  uint32_t last_publish_{ 0 };
+  /// The state as last published, to drop publishes that change nothing
+  float published_current_temperature_{ NAN };
+  float published_target_temperature_{ NAN };
+  climate::ClimateMode published_mode_{ climate::CLIMATE_MODE_OFF };
+  climate::ClimateAction published_action_{ climate::CLIMATE_ACTION_OFF };
+  int published_fan_index_{ -1 };
+};
+
+} // namespace register_climate
+} // namespace esphome
@@ -1,50 +1,39 @@
 #pragma once
 
 #include "esphome/core/component.h"
-#include "esphome/components/climate/climate.h"
-#include "esphome/components/sensor/sensor.h"
-#include "esphome/components/number/number.h"
+#include "esphome/components/register_climate/register_climate.h"
 
 namespace esphome {
 namespace sentio {
-class SentioClimate : public climate::Climate, public Component {
+
+using register_climate::ModeMapping;
+
+class SentioClimate : public register_climate::RegisterClimate<SentioClimate> {
 public:
 
   SentioClimate() {}
 
-  void setup() override;
   void dump_config() override;
 
-  void current_temp_sensor(sensor::Sensor *sensor) {
-    this->current_temp_sensor_ = sensor;
-  }
-
-  void set_temp_setpoint_number(number::Number *number) {
-    this->temp_setpoint_number_ = number;
-  }
-
    void mode_select(sensor::Sensor *sensor) {
     this->mode_select_ = sensor;
   } 
 
-protected:
-  /// Override control to change settings of the climate device.
-  void control(const climate::ClimateCall& call) override;
-
-  /// Return the traits of this controller.
-  climate::ClimateTraits traits() override;
+  /// Room mode register value to climate mode
+  static constexpr std::array<ModeMapping, 3> MODES{{
+    {1, climate::CLIMATE_MODE_OFF},
+    {2, climate::CLIMATE_MODE_HEAT},
+    {3, climate::CLIMATE_MODE_COOL},
+  }};
+  static constexpr climate::ClimateMode FALLBACK_MODE = climate::CLIMATE_MODE_OFF;
 
-  /// The sensor used for getting the current temperature
-  sensor::Sensor *current_temp_sensor_{ nullptr };
+protected:
+  friend class register_climate::RegisterClimate<SentioClimate>;
 
-  /// The number component used for getting the temperature setpoint
-  number::Number *temp_setpoint_number_{ nullptr };
+  void build_traits(climate::ClimateTraits &traits);
+  void bind_mode_source();
 
   sensor::Sensor *mode_select_{ nullptr };
-
-private:
-  void sentio_mode_to_climatemode(const int state);
-  
 };
 } // namespace sentio
 } // namespace esphome
@@ -1,22 +1,138 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome import core, pins
-from esphome.components import modbus
-from esphome.const import CONF_ID, CONF_RW_PIN
+from esphome.components import modbus, sensor
+from esphome.const import (
+    CONF_BAUD_RATE,
+    CONF_ID,
+    CONF_RW_PIN,
+    CONF_CHANNEL,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
+)
+
+AUTO_LOAD = ['wavin_protocol', 'sensor']
+MULTI_CONF = True
 
 wavinAhc9000_ns = cg.esphome_ns.namespace('wavinAhc9000')
 WavinAhc9000 = wavinAhc9000_ns.class_('WavinAhc9000', cg.PollingComponent)
 
 CONF_WAVINAHC9000_ID = 'wavinAhc9000_id'
+CONF_REDISCOVERY_INTERVAL = 'rediscovery_interval'
+CONF_MIN_TIMEOUT = 'min_timeout'
+CONF_MAX_TIMEOUT = 'max_timeout'
+CONF_RETRIES = 'retries'
+CONF_TEMPERATURE_DEADBAND = 'temperature_deadband'
+CONF_HEARTBEAT = 'heartbeat'
+CONF_OUTPUT_INTERVAL = 'output_interval'
+CONF_TEMPERATURE_INTERVAL = 'temperature_interval'
+CONF_TEMPERATURE_MAX_INTERVAL = 'temperature_max_interval'
+CONF_BATTERY_INTERVAL = 'battery_interval'
+CONF_SETPOINT_INTERVAL = 'setpoint_interval'
+CONF_MODE_INTERVAL = 'mode_interval'
+CONF_WRITE_REFRESH_DELAY = 'write_refresh_delay'
+CONF_DIAGNOSTICS = 'diagnostics'
+CONF_REQUESTS = 'requests'
+CONF_TIMEOUTS = 'timeouts'
+CONF_INVALID_REPLIES = 'invalid_replies'
+CONF_RTT_MEAN = 'rtt_mean'
+CONF_RTT_MAX = 'rtt_max'
+CONF_SCAN_DURATION = 'scan_duration'
+CONF_LAST_SUCCESS_AGE = 'last_success_age'
+CONF_CHANNELS = 'channels'
+
+COUNTER_SCHEMA = sensor.sensor_schema(accuracy_decimals=0, state_class=STATE_CLASS_TOTAL_INCREASING,
+                                      entity_category=ENTITY_CATEGORY_DIAGNOSTIC)
+DURATION_SCHEMA = sensor.sensor_schema(unit_of_measurement=UNIT_MILLISECOND, accuracy_decimals=1,
+                                       state_class=STATE_CLASS_MEASUREMENT, entity_category=ENTITY_CATEGORY_DIAGNOSTIC)
+AGE_SCHEMA = sensor.sensor_schema(unit_of_measurement=UNIT_SECOND, accuracy_decimals=0,
+                                  state_class=STATE_CLASS_MEASUREMENT, entity_category=ENTITY_CATEGORY_DIAGNOSTIC)
+
+CHANNEL_DIAGNOSTICS_SCHEMA = cv.Schema({
+    cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=16),
+    cv.Optional(CONF_REQUESTS): COUNTER_SCHEMA,
+    cv.Optional(CONF_TIMEOUTS): COUNTER_SCHEMA,
+    cv.Optional(CONF_LAST_SUCCESS_AGE): AGE_SCHEMA,
+})
+
+def validate_unique_channels(channels):
+    seen = set()
+    for channel_conf in channels:
+        if channel_conf[CONF_CHANNEL] in seen:
+            raise cv.Invalid(f'channel {channel_conf[CONF_CHANNEL]} is listed more than once')
+        seen.add(channel_conf[CONF_CHANNEL])
+    return channels
+
+DIAGNOSTICS_SCHEMA = cv.Schema({
+    cv.Optional(CONF_REQUESTS): COUNTER_SCHEMA,
+    cv.Optional(CONF_TIMEOUTS): COUNTER_SCHEMA,
+    cv.Optional(CONF_INVALID_REPLIES): COUNTER_SCHEMA,
+    cv.Optional(CONF_RTT_MEAN): DURATION_SCHEMA,
+    cv.Optional(CONF_RTT_MAX): DURATION_SCHEMA,
+    cv.Optional(CONF_SCAN_DURATION): DURATION_SCHEMA,
+    cv.Optional(CONF_LAST_SUCCESS_AGE): AGE_SCHEMA,
+    cv.Optional(CONF_CHANNELS): cv.All(cv.ensure_list(CHANNEL_DIAGNOSTICS_SCHEMA), validate_unique_channels),
+})
+
+def validate_timeouts(config):
+    if config[CONF_MIN_TIMEOUT] > config[CONF_MAX_TIMEOUT]:
+        raise cv.Invalid(f'{CONF_MIN_TIMEOUT} can\'t be larger than {CONF_MAX_TIMEOUT}')
+    return config
 
-CONFIG_SCHEMA = cv.Schema({
+CONFIG_SCHEMA = cv.All(cv.Schema({
     cv.GenerateID(): cv.declare_id(WavinAhc9000),
-    cv.Required(CONF_RW_PIN): pins.gpio_output_pin_schema
-}).extend(cv.polling_component_schema('60s')).extend(modbus.modbus_device_schema(0x01))
+    cv.Optional(CONF_RW_PIN): pins.gpio_output_pin_schema,
+    cv.Optional(CONF_BAUD_RATE, default=38400): cv.int_range(min=1200, max=115200),
+    cv.Optional(CONF_REDISCOVERY_INTERVAL, default='60min'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_MIN_TIMEOUT, default='50ms'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_MAX_TIMEOUT, default='1000ms'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_RETRIES, default=2): cv.int_range(min=0, max=10),
+    cv.Optional(CONF_TEMPERATURE_DEADBAND, default=0.0): cv.positive_float,
+    cv.Optional(CONF_HEARTBEAT, default='10min'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_OUTPUT_INTERVAL, default='0s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_TEMPERATURE_INTERVAL, default='0s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_TEMPERATURE_MAX_INTERVAL, default='0s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_BATTERY_INTERVAL, default='0s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_SETPOINT_INTERVAL, default='0s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_MODE_INTERVAL, default='0s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_WRITE_REFRESH_DELAY, default='1s'): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_DIAGNOSTICS): DIAGNOSTICS_SCHEMA,
+}).extend(cv.polling_component_schema('60s')).extend(modbus.modbus_device_schema(0x01)), validate_timeouts)
 
 def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     yield cg.register_component(var, config)
     yield modbus.register_modbus_device(var, config)
-    pin = yield cg.gpio_pin_expression(config[CONF_RW_PIN])
-    cg.add(var.set_rw_pin(pin))
+    if CONF_RW_PIN in config:
+        pin = yield cg.gpio_pin_expression(config[CONF_RW_PIN])
+        cg.add(var.set_rw_pin(pin))
+    cg.add(var.set_baud_rate(config[CONF_BAUD_RATE]))
+    cg.add(var.set_rediscovery_interval(config[CONF_REDISCOVERY_INTERVAL]))
+    cg.add(var.set_min_timeout(config[CONF_MIN_TIMEOUT]))
+    cg.add(var.set_max_timeout(config[CONF_MAX_TIMEOUT]))
+    cg.add(var.set_retries(config[CONF_RETRIES]))
+    cg.add(var.set_temperature_deadband(config[CONF_TEMPERATURE_DEADBAND]))
+    cg.add(var.set_heartbeat(config[CONF_HEARTBEAT]))
+    cg.add(var.set_output_interval(config[CONF_OUTPUT_INTERVAL]))
+    cg.add(var.set_temperature_interval(config[CONF_TEMPERATURE_INTERVAL]))
+    cg.add(var.set_temperature_max_interval(config[CONF_TEMPERATURE_MAX_INTERVAL]))
+    cg.add(var.set_battery_interval(config[CONF_BATTERY_INTERVAL]))
+    cg.add(var.set_setpoint_interval(config[CONF_SETPOINT_INTERVAL]))
+    cg.add(var.set_mode_interval(config[CONF_MODE_INTERVAL]))
+    cg.add(var.set_write_refresh_delay(config[CONF_WRITE_REFRESH_DELAY]))
+    if CONF_DIAGNOSTICS in config:
+        diagnostics = config[CONF_DIAGNOSTICS]
+        for key in [CONF_REQUESTS, CONF_TIMEOUTS, CONF_INVALID_REPLIES, CONF_RTT_MEAN, CONF_RTT_MAX,
+                    CONF_SCAN_DURATION, CONF_LAST_SUCCESS_AGE]:
+            if key in diagnostics:
+                sens = yield sensor.new_sensor(diagnostics[key])
+                cg.add(getattr(var, f'set_{key}_sensor')(sens))
+        for channel_conf in diagnostics.get(CONF_CHANNELS, []):
+            channel = channel_conf[CONF_CHANNEL] - 1
+            for key in [CONF_REQUESTS, CONF_TIMEOUTS, CONF_LAST_SUCCESS_AGE]:
+                if key in channel_conf:
+                    sens = yield sensor.new_sensor(channel_conf[key])
+                    cg.add(getattr(var, f'set_channel_{key}_sensor')(channel, sens))
@@ -36,10 +36,12 @@ def to_code(config):
     yield cg.register_component(var, config)
     yield climate.register_climate(var, config)
  
-    cg.add(var.set_channel(config[CONF_CHANNEL] - 1))
+    channel = config[CONF_CHANNEL] - 1
+    cg.add(var.set_channel(channel))
+    # the sensors are bound to the hub directly, it publishes to them without going through the climate
     if CONF_BATTERY_LEVEL in config:
         sens = yield sensor.new_sensor(config[CONF_BATTERY_LEVEL])
-        cg.add(var.set_battery_level_sensor(sens))
+        cg.add(wavin.set_channel_battery_sensor(channel, sens))
     if CONF_CURRENT_TEMP in config:
         sens = yield sensor.new_sensor(config[CONF_CURRENT_TEMP])
-        cg.add(var.set_current_temp_sensor(sens))
+        cg.add(wavin.set_channel_temperature_sensor(channel, sens))
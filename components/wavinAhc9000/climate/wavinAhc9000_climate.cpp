@@ -7,40 +7,49 @@ namespace wavinAhc9000 {
 static const char *TAG = "wavinAhc9000.climate";
 
 void WavinAhc9000Climate::setup() {
-  wavin_->add_temp_callback(channel_, [this](float state) {
-    if (current_temperature != state) {
-      current_temperature = state;
-      publish_state();
-    }
-  });
-  wavin_->add_target_temp_callback(channel_, [this](float state) {
-    if (target_temperature != state) {
-      target_temperature = state;
-      publish_state();
-    }
-  });
-  wavin_->add_output_callback(channel_, [this](bool is_on) {
-    if (is_on && (mode != climate::CLIMATE_MODE_HEAT)) {
-      mode = climate::CLIMATE_MODE_HEAT;
-      publish_state();
-    } else if (!is_on && (mode != climate::CLIMATE_MODE_OFF)) {
-      mode = climate::CLIMATE_MODE_OFF;
-      publish_state();
-    }
-  });
-  if (battery_level_sensor_ != nullptr) {
-    wavin_->add_bat_level_callback(channel_, [this](int level) {
-      battery_level_sensor_->publish_state(level);
-    });
+  wavin_->set_channel_listener(channel_, this);
+}
+
+void WavinAhc9000Climate::on_temperature(float temperature) {
+  if (current_temperature != temperature) {
+    current_temperature = temperature;
+    publish_state();
+  }
+}
+
+void WavinAhc9000Climate::on_target_temp(float temperature) {
+  if (target_temperature != temperature) {
+    target_temperature = temperature;
+    publish_state();
+  }
+}
+
+// The output shows whether the channel is heating right now, the mode whether the channel is in standby
+void WavinAhc9000Climate::on_output(bool on) {
+  climate::ClimateAction new_action = on ? climate::CLIMATE_ACTION_HEATING : climate::CLIMATE_ACTION_IDLE;
+  if (action != new_action) {
+    action = new_action;
+    publish_state();
+  }
+}
+
+void WavinAhc9000Climate::on_mode(int wavin_mode) {
+  climate::ClimateMode new_mode = wavin_mode == wavin_protocol::CONFIGURATION_MODE_STANDBY
+                                      ? climate::CLIMATE_MODE_OFF : climate::CLIMATE_MODE_HEAT;
+  if (mode != new_mode) {
+    mode = new_mode;
+    publish_state();
   }
-  if (current_temp_sensor_ != nullptr) {
-    wavin_->add_temp_callback(channel_, [this](float state) {
-      current_temp_sensor_->publish_state(state);
-    });
-  }  
 }
 
 void WavinAhc9000Climate::control(const climate::ClimateCall &call) {
+  if (call.get_mode().has_value()) {
+    mode = *call.get_mode();
+    ESP_LOGD(TAG, "Mode for channel %d changed to: %s", channel_ + 1,
+             mode == climate::CLIMATE_MODE_OFF ? "standby" : "heat");
+    wavin_->set_standby(channel_, mode == climate::CLIMATE_MODE_OFF);
+    publish_state();
+  }
   if (call.get_target_temperature().has_value()) {
     target_temperature = *call.get_target_temperature();
     float target = target_temperature;
@@ -54,6 +63,8 @@ void WavinAhc9000Climate::control(const climate::ClimateCall &call) {
 climate::ClimateTraits WavinAhc9000Climate::traits() {
   auto traits = climate::ClimateTraits();
   traits.set_supports_current_temperature(true);
+  traits.set_supports_action(true);
+  traits.set_supported_modes({climate::CLIMATE_MODE_HEAT, climate::CLIMATE_MODE_OFF});
   return traits;
 }
 
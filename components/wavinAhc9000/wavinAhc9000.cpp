@@ -6,231 +6,701 @@ namespace wavinAhc9000 {
 
 static const char *TAG = "wavin";
 
-static const uint8_t MODBUS_READ_REGISTER = 0x43;
-static const uint8_t MODBUS_WRITE_REGISTER = 0x44;
-static const uint8_t MODBUS_WRITE_MASKED_REGISTER = 0x45;
+using namespace wavin_protocol;
 
-static const uint8_t CATEGORY_MAIN = 0x00;
-static const uint8_t CATEGORY_ELEMENTS = 0x01;
-static const uint8_t CATEGORY_PACKED_DATA = 0x02;
-static const uint8_t CATEGORY_CHANNELS = 0x03;
+// The channel page is read from TIMER EVENT up to and including PRIMARY ELEMENT
+static const uint8_t CHANNEL_READ_COUNT = CHANNELS_PRIMARY_ELEMENT + 1;
+// Fields on the same page are read as one block when both are due: AIR TEMP up to and including BATTERY, and
+// MANUAL TEMPERATURE up to and including CONFIGURATION
+static const uint8_t ELEMENT_READ_COUNT = ELEMENTS_BATTERY - ELEMENTS_AIR_TEMPERATURE + 1;
+static const uint8_t PACKED_DATA_READ_COUNT = PACKED_DATA_CONFIGURATION + 1;
 
-static const uint8_t PACKED_DATA_MANUAL_TEMPERATURE = 0x00;
-static const uint8_t PACKED_DATA_CONFIGURATION = 0x07;
+// Kinds of write transaction
+static const uint8_t WRITE_SETPOINT = 0;
+static const uint8_t WRITE_MODE = 1;
 
-static const uint8_t PRIMARY_ELEMENT_MASK = 0x3f;
-static const uint8_t ALL_TP_LOST_MASK = 0x02;
-static const uint8_t CHANNEL_OUTP_ON = 0x10;
-static const uint8_t MODE_MASK = 0x07;
+// Scan states, one block read per register page of a channel
+static const int STATE_CHANNEL = 1;
+static const int STATE_ELEMENT = 2;
+static const int STATE_PACKED = 3;
+
+// Bits of one character on the wire: start bit, 8 data bits, parity and stop bit. Without parity this leaves one
+// bit of guard per character.
+static const uint32_t CHAR_BITS = 11;
 
 void WavinAhc9000::setup() {
-  rw_pin_->pin_mode(gpio::FLAG_OUTPUT);
-  rw_pin_->digital_write(false);
+  timeout_us_ = max_timeout_ * 1000;
+  char_time_us_ = (CHAR_BITS * 1000000 + baud_rate_ - 1) / baud_rate_;
+  if (rw_pin_ != nullptr) {
+    rw_pin_->pin_mode(gpio::FLAG_OUTPUT);
+    rw_pin_->digital_write(false);
+  }
+#ifdef USE_ESP32
+  // only a pin of the chip itself can be switched from the timer task, an I/O expander pin keeps the blocking path
+  if (rw_pin_ != nullptr && rw_pin_->is_internal()) {
+    rw_isr_pin_ = static_cast<InternalGPIOPin *>(rw_pin_)->to_isr();
+    esp_timer_create_args_t timer_args{};
+    timer_args.callback = &WavinAhc9000::release_rw_pin_;
+    timer_args.arg = this;
+    timer_args.name = "wavin_rw";
+    if (esp_timer_create(&timer_args, &rw_timer_) != ESP_OK) {
+      ESP_LOGW(TAG, "Failed to create RW pin timer, falling back to blocking transmit");
+      rw_timer_ = nullptr;
+    }
+  }
+#endif
+  load_topology_();
+  arbiter_ = WavinBusArbiter::for_bus(parent_);
+  arbiter_->add(this);
 }
 
-void WavinAhc9000::add_temp_callback(int channel, std::function<void(float)> &&callback) {
-  temp_callbacks_[channel].add(std::move(callback));
+WavinBusArbiter *WavinBusArbiter::for_bus(modbus::Modbus *bus) {
+  static std::vector<WavinBusArbiter *> arbiters;
+  for (auto *arbiter : arbiters) {
+    if (arbiter->bus_ == bus)
+      return arbiter;
+  }
+  arbiters.push_back(new WavinBusArbiter(bus));  // NOLINT(cppcoreguidelines-owning-memory)
+  return arbiters.back();
 }
 
-void WavinAhc9000::add_bat_level_callback(int channel, std::function<void(float)> &&callback) {
-  bat_level_callbacks_[channel].add(std::move(callback));
+// Returns true when the hub may start a transaction. A free line goes to the first hub with a transaction ready,
+// counting from the hub after the one that had the line last.
+bool WavinBusArbiter::acquire(WavinAhc9000 *hub) {
+  if (owner_ == hub)
+    return true;
+  size_t index = std::find(hubs_.begin(), hubs_.end(), hub) - hubs_.begin();
+  waiting_ |= 1 << index;
+  if (owner_ != nullptr)
+    return false;
+  for (size_t i = 0; i < hubs_.size(); i++) {
+    size_t candidate = (turn_ + i) % hubs_.size();
+    if (waiting_ & (1 << candidate)) {
+      if (candidate != index)
+        return false;
+      break;
+    }
+  }
+  owner_ = hub;
+  waiting_ &= ~(1 << index);
+  turn_ = (index + 1) % hubs_.size();
+  return true;
 }
 
-void WavinAhc9000::add_target_temp_callback(int channel, std::function<void(float)> &&callback) {
-  target_temp_callbacks_[channel].add(std::move(callback));
+void WavinBusArbiter::release(WavinAhc9000 *hub) {
+  if (owner_ == hub)
+    owner_ = nullptr;
 }
 
-void WavinAhc9000::add_mode_callback(int channel, std::function<void(int)> &&callback) {
-  mode_callbacks_[channel].add(std::move(callback));
+#ifdef USE_ESP32
+// Runs from the esp_timer task once the frame has left the UART
+void WavinAhc9000::release_rw_pin_(void *arg) {
+  static_cast<WavinAhc9000 *>(arg)->rw_isr_pin_.digital_write(false);
 }
+#endif
 
-void WavinAhc9000::add_output_callback(int channel, std::function<void(bool)> &&callback) {
-  output_callbacks_[channel].add(std::move(callback));
+void WavinAhc9000::begin_transmit_() {
+  if (rw_pin_ != nullptr)
+    rw_pin_->digital_write(true);
 }
 
+// Releases the driver enable once the frame is on the wire. On ESP32 a one-shot timer does this when the
+// last character has been shifted out, so the main loop doesn't wait for the transmission to finish.
+void WavinAhc9000::end_transmit_([[maybe_unused]] size_t frame_length) {
+  if (rw_pin_ == nullptr)
+    return;
+#ifdef USE_ESP32
+  if (rw_timer_ != nullptr) {
+    esp_timer_stop(rw_timer_);
+    esp_timer_start_once(rw_timer_, (frame_length + 1) * char_time_us_);
+    return;
+  }
+#endif
+  parent_->flush();
+  delay(1);
+  rw_pin_->digital_write(false);
+}
+
+void WavinAhc9000::load_topology_() {
+  topology_pref_ = global_preferences->make_preference<WavinTopology>(fnv1_hash("wavinAhc9000_topology") + address_);
+  WavinTopology topology;
+  if (!topology_pref_.load(&topology)) {
+    ESP_LOGD(TAG, "No stored channel topology, discovering all channels");
+    return;
+  }
+  for (int channel = 0; channel < 16; channel++) {
+    int8_t element = topology.element[channel];
+    if (element < ELEMENT_UNKNOWN || element > PRIMARY_ELEMENT_MASK)
+      element = ELEMENT_UNKNOWN;
+    channels_[channel].element = element;
+    ESP_LOGV(TAG, "Stored topology channel %d: element %d", channel + 1, element);
+  }
+}
+
+void WavinAhc9000::save_topology_() {
+  WavinTopology topology;
+  for (int channel = 0; channel < 16; channel++)
+    topology.element[channel] = channels_[channel].element;
+  if (!topology_pref_.save(&topology))
+    ESP_LOGW(TAG, "Failed to store channel topology");
+  topology_dirty_ = false;
+}
+
+// Only the latest setpoint per channel is kept, so repeated changes before the write goes out cost one transaction
 void WavinAhc9000::set_target_temp(int channel, float temperature) {
-  set_temp_.push_back(temperature);
-  temp_channel_.push_back(channel);
+  pending_setpoint_[channel] = ((roundf(temperature * 2.0) / 2) * 10);
+  ESP_LOGV(TAG, "Rounded to nearest half for channel %d: %d", channel + 1, pending_setpoint_[channel]);
+  pending_setpoints_ |= 1 << channel;
+}
+
+// Like setpoints, only the latest mode per channel is kept. The mode is written with a masked write, so the other
+// bits of the CONFIGURATION register are left alone without reading them first.
+void WavinAhc9000::set_mode(int channel, int mode) {
+  pending_mode_[channel] = mode & CONFIGURATION_MODE_MASK;
+  pending_modes_ |= 1 << channel;
+}
+
+void WavinAhc9000::set_standby(int channel, bool standby) {
+  set_mode(channel, standby ? CONFIGURATION_MODE_STANDBY : CONFIGURATION_MODE_MANUAL);
+}
+
+void WavinAhc9000::handle_write_data_(const std::vector<uint8_t> &data) {
+  RegisterView regs(data);
+  // The controller echoes the register content it actually stored
+  int written = regs.word(0);
+  ChannelState &ch = channels_[write_channel_];
+  if (write_kind_ == WRITE_MODE) {
+    written &= CONFIGURATION_MODE_MASK;
+    if (written != write_value_)
+      ESP_LOGW(TAG, "Channel %d stored mode %d instead of %d", write_channel_ + 1, written, write_value_);
+    if (ch.mode != written)
+      ch.temperature_interval = 0;
+    ch.mode = written;
+    ESP_LOGD(TAG, "Confirmed mode channel %i: %d", write_channel_ + 1, ch.mode);
+    request_refresh(write_channel_, FIELD_OUTPUT, write_refresh_delay_);
+    if (ch.mode != ch.published_mode)
+      publish_mode_(write_channel_);
+    return;
+  }
+  if (written != write_value_)
+    ESP_LOGW(TAG, "Channel %d stored target temperature %d instead of %d", write_channel_ + 1, written, write_value_);
+  float target_temp = written / 10.0;
+  if (target_temp != ch.target_temp)
+    ch.temperature_interval = 0;
+  ch.target_temp = target_temp;
+  ESP_LOGD(TAG, "Confirmed target temperature channel %i: %.1f", write_channel_ + 1, ch.target_temp);
+  request_refresh(write_channel_, FIELD_OUTPUT, write_refresh_delay_);
+  if (ch.target_temp != ch.published_target_temp)
+    publish_target_temp_(write_channel_);
 }
 
 void WavinAhc9000::on_modbus_data(const std::vector<uint8_t> &data) {
   ESP_LOGV(TAG, "Channel %d, state %d, Data: %s", channel_ + 1, state_, hexencode(data).c_str());
-  float temperature;
+  if (!waiting_ && !guarding_) {
+    ESP_LOGD(TAG, "Ignoring reply on channel %d, state %d, no request in flight", channel_ + 1, state_);
+    invalid_replies_++;
+    return;
+  }
+  // Replies carry no request id, a reply of another length belongs to an earlier request and the one in flight
+  // can still come in
+  if (data.size() != 2 * reply_count_) {
+    ESP_LOGW(TAG, "Unexpected reply on channel %d, state %d (%d bytes instead of %d)", transaction_channel_() + 1,
+             state_, data.size(), 2 * reply_count_);
+    invalid_replies_++;
+    return;
+  }
+  // nothing was sent since the last attempt, so a reply during the guard period still belongs to it
+  if (attempts_ == 1) {  // only unambiguous round trips are sampled
+    uint32_t rtt_us = micros() - last_send_us_;
+    update_timeout_(rtt_us);
+    rtt_max_us_ = std::max(rtt_max_us_, rtt_us);
+  }
+  waiting_ = false;
+  guarding_ = false;
+  arbiter_->release(this);
+  last_success_ = millis();
+  channel_stats_[transaction_channel_()].last_success = last_success_;
+  if (write_channel_ >= 0) {
+    handle_write_data_(data);
+    write_channel_ = -1;
+    return;
+  }
   switch (state_) {
-    case 0:
-      temperature = ((data[0] << 8) + data[1]) / 10.0;
-      ESP_LOGD(TAG, "Confirmed target temperature channel %i: %.1f", channel_ + 1, temperature);
-      channel_ = -1;
-      break;
-    case 1:
+    case STATE_CHANNEL:
       handle_channel_data_(data);
       break;
-    case 2:
+    case STATE_ELEMENT:
       handle_element_data_(data);
       break;
-    case 3:
-      handle_target_temp_data_(data);
-      break;
-    case 4:
-      handle_mode_data_(data);
+    case STATE_PACKED:
+      handle_packed_data_(data);
       break;
   }
-  waiting_ = false;
 }
 
 void WavinAhc9000::handle_channel_data_(const std::vector<uint8_t> &data) {
-  element_ = (data[5] & PRIMARY_ELEMENT_MASK) - 1;
-  if (element_ == -1) { // this channel isn't used
+  RegisterView regs(data);
+  ChannelState &ch = channels_[channel_];
+  uint16_t primary_element = regs.word(CHANNELS_PRIMARY_ELEMENT);
+  int8_t element = (primary_element & PRIMARY_ELEMENT_MASK) - 1;
+  if (element != ch.element) {
+    ESP_LOGD(TAG, "Primary element of channel %d changed from %d to %d", channel_ + 1, ch.element, element);
+    ch.element = element;
+    topology_dirty_ = true;
+  }
+  if (element == ELEMENT_UNUSED) { // this channel isn't used
     ESP_LOGV(TAG, "Channel %d isn't used", channel_ + 1);
-    state_ = 4;
+    state_ = STATE_PACKED;
     return;
   }
-  if (data[0] & ALL_TP_LOST_MASK) {
+  if (primary_element & PRIMARY_ELEMENT_ALL_TP_LOST) {
     ESP_LOGD(TAG, "All TP lost for channel %d", channel_ + 1);
     state_++; // skip temp and bat data
   }
-  bool output_on = data[1] & CHANNEL_OUTP_ON;
-  ESP_LOGD(TAG, "Status channel %i: %s",channel_ + 1, ONOFF(output_on));
-  output_callbacks_[channel_].call(output_on);
+  bool output_on = regs.word(CHANNELS_TIMER_EVENT) & TIMER_EVENT_OUTP_ON;
+  if ((ch.seen & FIELD_OUTPUT) && output_on != ch.output_on) {
+    // the controller switched the output, so the room temperature and setpoint likely moved too. They are read
+    // right after this in the same pass, and the temperature is polled closely again.
+    ESP_LOGV(TAG, "Output of channel %d switched, refreshing temperature and setpoint", channel_ + 1);
+    due_ |= FIELD_TEMPERATURE | FIELD_SETPOINT;
+    ch.temperature_interval = 0;
+  }
+  ch.output_on = output_on;
+  mark_read_(ch, FIELD_OUTPUT);
 }
 
 void WavinAhc9000::handle_element_data_(const std::vector<uint8_t> &data) {
-  float temperature = ((data[0] << 8) + data[1]) / 10.0;
-  int battery = data[13] * 10;
-  ESP_LOGD(TAG, "Temperature channel %i: %.1f", channel_ + 1, temperature);
-  ESP_LOGD(TAG, "Battery channel %i: %i", channel_ + 1, battery);
-  temp_callbacks_[channel_].call(temperature);
-  bat_level_callbacks_[channel_].call(battery);
-}
-
-void WavinAhc9000::handle_target_temp_data_(const std::vector<uint8_t> &data) {
-  float temperature = ((data[0] << 8) + data[1]) / 10.0;
-  ESP_LOGD(TAG, "Target temperature channel %i: %.1f", channel_ + 1, temperature);
-  target_temp_callbacks_[channel_].call(temperature);
-}
-
-void WavinAhc9000::handle_mode_data_(const std::vector<uint8_t> &data) {
-  int mode = data[0] & MODE_MASK;
-  ESP_LOGD(TAG, "Mode channel %i: %d",channel_ + 1, mode );
-  mode_callbacks_[channel_].call(mode);
-}
-
-uint16_t crc16(const uint8_t *data, uint8_t len) {
-  uint16_t crc = 0xFFFF;
-  while (len--) {
-    crc ^= *data++;
-    for (uint8_t i = 0; i < 8; i++) {
-      if ((crc & 0x01) != 0) {
-        crc >>= 1;
-        crc ^= 0xA001;
-      } else {
-        crc >>= 1;
-      }
+  // Either AIR TEMP alone or the block from AIR TEMP through BATTERY
+  RegisterView regs(data);
+  ChannelState &ch = channels_[channel_];
+  float temperature = regs.word(0) / 10.0;
+  if (ch.seen & FIELD_TEMPERATURE)
+    adapt_temperature_interval_(ch, temperature - ch.temperature, scan_start_ - ch.last_read[1]);
+  ch.temperature = temperature;
+  uint8_t fields = FIELD_TEMPERATURE;
+  if (read_count_ == ELEMENT_READ_COUNT) {
+    ch.battery = regs.low(ELEMENTS_BATTERY - ELEMENTS_AIR_TEMPERATURE) * 10;
+    fields |= FIELD_BATTERY;
+  }
+  mark_read_(ch, fields);
+}
+
+void WavinAhc9000::handle_packed_data_(const std::vector<uint8_t> &data) {
+  // Either MANUAL TEMPERATURE alone or the block from MANUAL TEMPERATURE through CONFIGURATION
+  RegisterView regs(data);
+  ChannelState &ch = channels_[channel_];
+  float target_temp = regs.word(PACKED_DATA_MANUAL_TEMPERATURE) / 10.0;
+  if ((ch.seen & FIELD_SETPOINT) && target_temp != ch.target_temp)
+    ch.temperature_interval = 0; // changed at the thermostat, the zone is about to start or stop heating
+  ch.target_temp = target_temp;
+  uint8_t fields = FIELD_SETPOINT;
+  if (read_count_ == PACKED_DATA_READ_COUNT) {
+    ch.mode = regs.word(PACKED_DATA_CONFIGURATION) & CONFIGURATION_MODE_MASK;
+    fields |= FIELD_MODE;
+  }
+  mark_read_(ch, fields);
+}
+
+void WavinAhc9000::mark_read_(ChannelState &ch, uint8_t fields) {
+  ch.updated |= fields;
+  ch.seen |= fields;
+  for (int field = 0; field < FIELD_COUNT; field++) {
+    if (fields & (1 << field))
+      ch.last_read[field] = scan_start_;
+  }
+}
+
+// Takes the lowest channel out of a pending write mask
+int WavinAhc9000::next_pending_(uint16_t &pending) {
+  int channel = 0;
+  while (!(pending & (1 << channel)))
+    channel++;
+  pending &= ~(1 << channel);
+  return channel;
+}
+
+// Returns the first channel from the given one that needs scanning, skipping channels known to be unused. A refresh
+// pass only visits the channels that asked for one.
+int WavinAhc9000::next_scan_channel_(int channel) {
+  while (channel < 16 && ((!discovery_scan_ && channels_[channel].element == ELEMENT_UNUSED) ||
+                          (refresh_scan_ && !(pending_refreshes_ & (1 << channel)))))
+    channel++;
+  return channel;
+}
+
+// Moves the scan to the first channel from the given one that needs scanning, before its first state. Refreshes
+// requested for that channel are taken along.
+void WavinAhc9000::start_channel_(int channel) {
+  channel_ = next_scan_channel_(channel);
+  state_ = 0;
+  if (channel_ > 15) {
+    due_ = 0;
+    return;
+  }
+  due_ = refresh_scan_ ? 0 : due_fields_(channel_);
+  due_ |= refresh_fields_[channel_];
+  refresh_fields_[channel_] = 0;
+  pending_refreshes_ &= ~(1 << channel_);
+}
+
+// Schedules a re-read of some fields of one channel, without waiting for their interval or the next update. Requests
+// are collected for delay ms and then read in one pass over the channels that asked.
+void WavinAhc9000::request_refresh(int channel, uint8_t fields, uint32_t delay) {
+  if (!pending_refreshes_)
+    refresh_at_ = millis() + delay;
+  refresh_fields_[channel] |= fields;
+  pending_refreshes_ |= 1 << channel;
+}
+
+// Fields of a channel that haven't been read yet or whose interval has passed at the start of this scan.
+// Intervals are measured between scan starts, so they are effectively rounded up to the update interval.
+uint8_t WavinAhc9000::due_fields_(int channel) const {
+  const ChannelState &ch = channels_[channel];
+  uint8_t due = 0;
+  for (int field = 0; field < FIELD_COUNT; field++) {
+    if (!(ch.seen & (1 << field)) || scan_start_ - ch.last_read[field] >= field_interval_of_(ch, field))
+      due |= 1 << field;
+  }
+  return due;
+}
+
+// The adaptive interval is at least one update interval, so half an update interval can be taken off. A scan that
+// started a little later than the previous one then doesn't push the read out by a whole update.
+uint32_t WavinAhc9000::field_interval_of_(const ChannelState &ch, int field) const {
+  if (field != 1 || temperature_max_interval_ == 0)
+    return field_interval_[field];
+  return std::max(ch.temperature_interval, temperature_min_interval_()) - get_update_interval() / 2;
+}
+
+// The adaptive temperature interval starts at temperature_interval, but at least one update interval since
+// shorter ones can't be told apart
+uint32_t WavinAhc9000::temperature_min_interval_() const {
+  return std::max(field_interval_[1], get_update_interval());
+}
+
+// Room temperatures of floor heating move slowly, so the temperature of a stable zone is read less and less often
+// by doubling its interval up to temperature_max_interval. When it did move, the next read is planned for when it
+// is expected to have moved another step (0.1 °C or the deadband) at the same rate. Output switches and setpoint or
+// mode changes reset the interval to the shortest one.
+void WavinAhc9000::adapt_temperature_interval_(ChannelState &ch, float change, uint32_t elapsed) {
+  if (temperature_max_interval_ == 0)
+    return;
+  uint32_t min_interval = temperature_min_interval_();
+  float step = std::max(temperature_deadband_, 0.1f);
+  uint32_t interval;
+  if (fabsf(change) < 0.05f)
+    interval = std::max(ch.temperature_interval, min_interval) * 2;
+  else
+    interval = elapsed * (step / fabsf(change));
+  ch.temperature_interval = std::max(min_interval, std::min(interval, temperature_max_interval_));
+  ESP_LOGV(TAG, "Temperature interval of channel %d: %u ms", channel_ + 1, ch.temperature_interval);
+}
+
+// Whether the given state of the current channel has a read to do. The channel page is also read before the
+// element page, as it tells which element to read and whether its thermostat is reachable.
+bool WavinAhc9000::state_due_(int state) const {
+  const ChannelState &ch = channels_[channel_];
+  switch (state) {
+    case STATE_CHANNEL:
+      return discovery_scan_ || ch.element == ELEMENT_UNKNOWN ||
+             (due_ & (FIELD_OUTPUT | FIELD_TEMPERATURE | FIELD_BATTERY));
+    case STATE_ELEMENT:
+      return ch.element >= 0 && (due_ & (FIELD_TEMPERATURE | FIELD_BATTERY));
+    case STATE_PACKED:
+      return ch.element != ELEMENT_UNUSED && (due_ & (FIELD_SETPOINT | FIELD_MODE));
+  }
+  return false;
+}
+
+bool WavinAhc9000::temperature_changed_(float value, float published) const {
+  if (std::isnan(published))
+    return true;
+  if (temperature_deadband_ > 0)
+    return fabsf(value - published) >= temperature_deadband_;
+  return value != published;
+}
+
+void WavinAhc9000::publish_output_(int channel) {
+  ChannelState &ch = channels_[channel];
+  ch.published_output = ch.output_on;
+  if (bindings_[channel].listener != nullptr)
+    bindings_[channel].listener->on_output(ch.output_on);
+}
+
+void WavinAhc9000::publish_temperature_(int channel) {
+  ChannelState &ch = channels_[channel];
+  ch.published_temperature = ch.temperature;
+  if (bindings_[channel].listener != nullptr)
+    bindings_[channel].listener->on_temperature(ch.temperature);
+  if (bindings_[channel].temperature_sensor != nullptr)
+    bindings_[channel].temperature_sensor->publish_state(ch.temperature);
+}
+
+void WavinAhc9000::publish_battery_(int channel) {
+  ChannelState &ch = channels_[channel];
+  ch.published_battery = ch.battery;
+  if (bindings_[channel].battery_sensor != nullptr)
+    bindings_[channel].battery_sensor->publish_state(ch.battery);
+}
+
+void WavinAhc9000::publish_target_temp_(int channel) {
+  ChannelState &ch = channels_[channel];
+  ch.published_target_temp = ch.target_temp;
+  if (bindings_[channel].listener != nullptr)
+    bindings_[channel].listener->on_target_temp(ch.target_temp);
+}
+
+void WavinAhc9000::publish_mode_(int channel) {
+  ChannelState &ch = channels_[channel];
+  ch.published_mode = ch.mode;
+  if (bindings_[channel].listener != nullptr)
+    bindings_[channel].listener->on_mode(ch.mode);
+}
+
+// A value is only published when it changed since it was last published, or for every value read in this scan
+// once the heartbeat interval of the channel has passed
+void WavinAhc9000::publish_snapshot_() {
+  uint32_t now = millis();
+  for (int channel = 0; channel < 16; channel++) {
+    ChannelState &ch = channels_[channel];
+    bool heartbeat = (heartbeat_ > 0) && (now - ch.last_heartbeat >= heartbeat_);
+    if (heartbeat && ch.updated)
+      ch.last_heartbeat = now;
+    if ((ch.updated & FIELD_OUTPUT) && (heartbeat || ch.output_on != ch.published_output)) {
+      ESP_LOGD(TAG, "Status channel %i: %s", channel + 1, ONOFF(ch.output_on));
+      publish_output_(channel);
+    }
+    if ((ch.updated & FIELD_TEMPERATURE) &&
+        (heartbeat || temperature_changed_(ch.temperature, ch.published_temperature))) {
+      ESP_LOGD(TAG, "Temperature channel %i: %.1f", channel + 1, ch.temperature);
+      publish_temperature_(channel);
+    }
+    if ((ch.updated & FIELD_BATTERY) && (heartbeat || ch.battery != ch.published_battery)) {
+      ESP_LOGD(TAG, "Battery channel %i: %i", channel + 1, ch.battery);
+      publish_battery_(channel);
+    }
+    if ((ch.updated & FIELD_SETPOINT) && (heartbeat || ch.target_temp != ch.published_target_temp)) {
+      ESP_LOGD(TAG, "Target temperature channel %i: %.1f", channel + 1, ch.target_temp);
+      publish_target_temp_(channel);
+    }
+    if ((ch.updated & FIELD_MODE) && (heartbeat || ch.mode != ch.published_mode)) {
+      ESP_LOGD(TAG, "Mode channel %i: %d", channel + 1, ch.mode);
+      publish_mode_(channel);
+    }
+    ch.updated = 0;
+  }
+}
+
+// Channel of the transaction in flight, a write or the current scan read
+int WavinAhc9000::transaction_channel_() const {
+  return write_channel_ >= 0 ? write_channel_ : channel_;
+}
+
+// Diagnostics are published once per scan, so keeping them enabled costs a few sensor updates per update interval
+void WavinAhc9000::publish_diagnostics_() {
+  uint32_t now = millis();
+  if (requests_sensor_ != nullptr)
+    requests_sensor_->publish_state(requests_);
+  if (timeouts_sensor_ != nullptr)
+    timeouts_sensor_->publish_state(timeouts_);
+  if (invalid_replies_sensor_ != nullptr)
+    invalid_replies_sensor_->publish_state(invalid_replies_);
+  if (rtt_mean_sensor_ != nullptr && srtt_us_ > 0)
+    rtt_mean_sensor_->publish_state(srtt_us_ / 1000.0f);
+  if (rtt_max_sensor_ != nullptr && rtt_max_us_ > 0)
+    rtt_max_sensor_->publish_state(rtt_max_us_ / 1000.0f);
+  rtt_max_us_ = 0;
+  if (scan_duration_sensor_ != nullptr)
+    scan_duration_sensor_->publish_state(scan_duration_);
+  if (last_success_age_sensor_ != nullptr && last_success_ != 0)
+    last_success_age_sensor_->publish_state((now - last_success_) / 1000.0f);
+  for (ChannelStats &stats : channel_stats_) {
+    if (stats.requests_sensor != nullptr)
+      stats.requests_sensor->publish_state(stats.requests);
+    if (stats.timeouts_sensor != nullptr)
+      stats.timeouts_sensor->publish_state(stats.timeouts);
+    if (stats.last_success_age_sensor != nullptr && stats.last_success != 0)
+      stats.last_success_age_sensor->publish_state((now - stats.last_success) / 1000.0f);
+  }
+}
+
+// Jacobson/Karels estimator as used by TCP: the timeout follows the smoothed round trip time plus four times its mean
+// deviation, which keeps it just above the tail of the observed reply latencies
+void WavinAhc9000::update_timeout_(uint32_t rtt_us) {
+  if (srtt_us_ == 0) {
+    srtt_us_ = rtt_us;
+    rttvar_us_ = rtt_us / 2;
+  } else {
+    uint32_t delta = rtt_us > srtt_us_ ? rtt_us - srtt_us_ : srtt_us_ - rtt_us;
+    rttvar_us_ = (3 * rttvar_us_ + delta) / 4;
+    srtt_us_ = (7 * srtt_us_ + rtt_us) / 8;
+  }
+  timeout_us_ = std::max(min_timeout_ * 1000, std::min(srtt_us_ + 4 * rttvar_us_, max_timeout_ * 1000));
+  ESP_LOGVV(TAG, "RTT %u us, timeout now %u us", rtt_us, timeout_us_);
+}
+
+// Sends the request of the current transaction, both for the first attempt and for retries
+void WavinAhc9000::transmit_request_() {
+  begin_transmit_();
+  if (write_channel_ >= 0 && write_kind_ == WRITE_MODE) {
+    ESP_LOGV(TAG, "Setting mode for channel %d: %d", write_channel_ + 1, write_value_);
+    auto frame = masked_write_frame(address_, CATEGORY_PACKED_DATA, PACKED_DATA_CONFIGURATION, write_channel_,
+                                    write_value_, ~CONFIGURATION_MODE_MASK);
+    parent_->write_array(frame.data(), frame.size());
+    end_transmit_(frame.size());
+    reply_count_ = 1;
+  } else if (write_channel_ >= 0) {
+    ESP_LOGV(TAG, "Setting temperature for channel %d: %d", write_channel_ + 1, write_value_);
+    auto frame = write_frame(address_, CATEGORY_PACKED_DATA, PACKED_DATA_MANUAL_TEMPERATURE, write_channel_,
+                             write_value_);
+    parent_->write_array(frame.data(), frame.size());
+    end_transmit_(frame.size());
+    reply_count_ = 1;
+  } else {
+    std::array<uint8_t, READ_FRAME_LENGTH> frame{};
+    ESP_LOGV(TAG, "Sending for channel %d, state %d", channel_ + 1, state_);
+    switch(state_) {
+      case STATE_CHANNEL:
+        read_count_ = CHANNEL_READ_COUNT;
+        frame = read_frame(address_, CATEGORY_CHANNELS, CHANNELS_TIMER_EVENT, channel_, read_count_);
+        break;
+      case STATE_ELEMENT:
+        ESP_LOGV(TAG, "Reading data for element %d", channels_[channel_].element);
+        read_count_ = (due_ & FIELD_BATTERY) ? ELEMENT_READ_COUNT : 1;
+        frame = read_frame(address_, CATEGORY_ELEMENTS, ELEMENTS_AIR_TEMPERATURE, channels_[channel_].element,
+                           read_count_);
+        break;
+      case STATE_PACKED:
+        read_count_ = (due_ & FIELD_MODE) ? PACKED_DATA_READ_COUNT : 1;
+        frame = read_frame(address_, CATEGORY_PACKED_DATA, PACKED_DATA_MANUAL_TEMPERATURE, channel_, read_count_);
+        break;
     }
+    parent_->write_array(frame.data(), frame.size());
+    end_transmit_(frame.size());
+    reply_count_ = read_count_;
   }
-  return crc;
+  waiting_ = true;
+  attempts_++;
+  requests_++;
+  channel_stats_[transaction_channel_()].requests++;
+  last_send_us_ = micros();
 }
 
 void WavinAhc9000::loop() {
-  static long last_update_time = 0;
-  long now = millis();
+  uint32_t now = millis();
   if (waiting_) {
-    if (last_update_time + 1000 < now) {
-      if (state_ == 0) {
-        ESP_LOGD(TAG, "Timeout on set temperature on channel %d", channel_ + 1);
-        channel_ = -1;
-      } else {
-        ESP_LOGD(TAG, "Timeout on channel %d, state %d", channel_ + 1, state_);
-        state_ = 4;
-      }
-      waiting_ = false;
-    } else {
+    if (micros() - last_send_us_ < timeout_us_)
       return;
+    waiting_ = false;
+    timeouts_++;
+    channel_stats_[transaction_channel_()].timeouts++;
+    // back off until a reply gives a fresh round trip sample
+    timeout_us_ = std::min(timeout_us_ * 2, max_timeout_ * 1000);
+    // The reply may only be late. Replies carry no request id, so the line is kept quiet for another timeout before
+    // anything else is sent, or a late reply would be taken for the reply to the next request.
+    guarding_ = true;
+    guard_start_us_ = micros();
+  }
+  if (guarding_) {
+    if (micros() - guard_start_us_ < timeout_us_)
+      return;
+    guarding_ = false;
+    if (attempts_ <= retries_) {
+      ESP_LOGD(TAG, "Timeout on channel %d, state %d, retry %d of %d", transaction_channel_() + 1, state_, attempts_,
+               retries_);
+      transmit_request_();
+      return;
+    }
+    if (write_channel_ >= 0) {
+      ESP_LOGD(TAG, "Timeout on %s write on channel %d", write_kind_ == WRITE_MODE ? "mode" : "temperature",
+               write_channel_ + 1);
+      write_channel_ = -1;
+    } else {
+      ESP_LOGD(TAG, "Timeout on channel %d, state %d", channel_ + 1, state_);
+      state_ = STATE_PACKED;
     }
+    arbiter_->release(this);
   }
 
-  if (set_temp_.size() && (channel_ < 0)) {
-    int temperature = ((roundf(set_temp_.front() * 2.0) / 2) * 10);
-    ESP_LOGV(TAG, "Rounded to nearest half for channel %d: %d", channel_ + 1, temperature);
-    set_temp_.erase(set_temp_.begin());
-    channel_ = temp_channel_.front();
-    temp_channel_.erase(temp_channel_.begin());
-    ESP_LOGV(TAG, "Setting temperature for channel %d: %d", channel_ + 1, temperature);
-    uint8_t data[10] = {address_, MODBUS_WRITE_REGISTER, CATEGORY_PACKED_DATA, PACKED_DATA_MANUAL_TEMPERATURE,
-                        (uint8_t)channel_, 1, (uint8_t)(temperature >> 8), (uint8_t)(temperature & 0xff), 0, 0};
-    uint16_t crc = crc16(data, 8);
-    data[8] = crc & 0xff;
-    data[9] = crc >> 8;
-    rw_pin_->digital_write(true);
-    parent_->write_array(data, sizeof(data));
-    parent_->flush();
-    delay(1);
-    rw_pin_->digital_write(false);
-    waiting_ = true;
-    last_update_time = now;
+  // the line is only claimed when there is something to send, and kept over retries until the transaction ends
+  bool refresh_due = pending_refreshes_ && (int32_t) (now - refresh_at_) >= 0;
+  if (!pending_setpoints_ && !pending_modes_ && !start_scan_ && !refresh_due && channel_ < 0)
+    return;
+  if (!arbiter_->acquire(this))
+    return;
+
+  // pending writes go out between scan transactions instead of waiting for the scan to finish, back to back when
+  // several channels have one
+  if (pending_setpoints_) {
+    write_channel_ = next_pending_(pending_setpoints_);
+    write_kind_ = WRITE_SETPOINT;
+    write_value_ = pending_setpoint_[write_channel_];
+    attempts_ = 0;
+    transmit_request_();
+    return;
+  }
+  if (pending_modes_) {
+    write_channel_ = next_pending_(pending_modes_);
+    write_kind_ = WRITE_MODE;
+    write_value_ = pending_mode_[write_channel_];
+    attempts_ = 0;
+    transmit_request_();
     return;
   }
 
-  if (start_scan_) {
+  // a refresh pass is short, an update that comes in while one runs is started after it
+  if (start_scan_ && !refresh_scan_) {
     start_scan_ = false;
-    channel_ = 0;
+    if (channel_ < 0) {
+      scan_start_ = now;
+      discovery_scan_ = now - last_discovery_ >= rediscovery_interval_;
+      if (discovery_scan_)
+        ESP_LOGD(TAG, "Rediscovering channel topology");
+      start_channel_(0);
+    } else {
+      ESP_LOGD(TAG, "Previous scan still running on channel %d, not restarting", channel_ + 1);
+    }
+  } else if (refresh_due && channel_ < 0) {
+    ESP_LOGV(TAG, "Refreshing channels 0x%04x", pending_refreshes_);
+    scan_start_ = now;
+    refresh_scan_ = true;
+    start_channel_(0);
   }
-  if (channel_ < 0)
+  if (channel_ < 0) {
+    arbiter_->release(this);
     return;
-  if (++state_ > 4) {
-    if (++channel_ > 15) {
-      state_ = 0;
-      channel_ = -1;
-      return;
+  }
+  // only the reads that are due are issued, channels with nothing due are passed over entirely
+  while (channel_ < 16 && !state_due_(++state_)) {
+    if (state_ >= STATE_PACKED)
+      start_channel_(channel_ + 1);
+  }
+  if (channel_ > 15) {
+    state_ = 0;
+    channel_ = -1;
+    if (discovery_scan_) {
+      discovery_scan_ = false;
+      last_discovery_ = now;
     }
-    state_ = 1;
+    if (topology_dirty_)
+      save_topology_();
+    if (refresh_scan_)
+      refresh_scan_ = false;
+    else
+      scan_duration_ = now - scan_start_;
+    arbiter_->release(this);
+    publish_snapshot_();
+    publish_diagnostics_();
+    return;
   }
 
-  rw_pin_->digital_write(true);
-  ESP_LOGV(TAG, "Sending for channel %d, state %d", channel_ + 1, state_);
-  switch(state_) {
-    case 1:
-      send(MODBUS_READ_REGISTER, (CATEGORY_CHANNELS << 8) + 0, (channel_ << 8) + 3);
-      break;
-    case 2:
-      ESP_LOGV(TAG, "Reading data for element %d", element_);
-      send(MODBUS_READ_REGISTER, (CATEGORY_ELEMENTS << 8) + 4, (element_ << 8) + 7);
-      break;
-    case 3:
-      send(MODBUS_READ_REGISTER, (CATEGORY_PACKED_DATA << 8) + PACKED_DATA_MANUAL_TEMPERATURE, (channel_ << 8) + 1);
-      break;
-    case 4:
-      send(MODBUS_READ_REGISTER, (CATEGORY_PACKED_DATA << 8) + PACKED_DATA_CONFIGURATION, (channel_ << 8) + 1);
-      break;
-  }
-  parent_->flush();
-  delay(1);
-  rw_pin_->digital_write(false);
-  waiting_ = true;
-  last_update_time = now;
+  attempts_ = 0;
+  transmit_request_();
 }
 
 void WavinAhc9000::update() {
   start_scan_ = true;
 }
 
-/*
-// ------------------------------------------------
-// Functions for writing to Wavin AHC 9000
-void WavinAhc9000::writeFanMode_(int new_fan_speed)
-{
-	
-	//ESP_LOGD(TAG, "Writing new fan speed to system.... (%i)",new_fan_speed);
-	//this->send(CMD_WRITE_SINGLE_REG, 100, new_fan_speed);
-}
-
-void WavinAhc9000::writeTargetTemperature_(float new_target_temp)
-{
-	
-	//ESP_LOGD(TAG, "Writing new fan speed to system.... (%i)",new_fan_speed);
-	//this->send(CMD_WRITE_SINGLE_REG, 100, new_fan_speed);
-}
-*/
-
 } // wavinAhc9000
 } // esphome
@@ -1,11 +1,107 @@
 #pragma once
 #include "esphome/core/component.h"
 #include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/modbus/modbus.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/wavin_protocol/wavin_protocol.h"
+
+#ifdef USE_ESP32
+#include <esp_timer.h>
+#endif
 
 namespace esphome {
 namespace wavinAhc9000 {
 
+// Primary element index of a channel: -1 when the channel isn't used, -2 until it has been discovered
+static const int8_t ELEMENT_UNUSED = -1;
+static const int8_t ELEMENT_UNKNOWN = -2;
+
+// Field classes of a channel, each read at its own interval
+static const uint8_t FIELD_OUTPUT = 0x01;
+static const uint8_t FIELD_TEMPERATURE = 0x02;
+static const uint8_t FIELD_BATTERY = 0x04;
+static const uint8_t FIELD_SETPOINT = 0x08;
+static const uint8_t FIELD_MODE = 0x10;
+static const int FIELD_COUNT = 5;
+
+// Last known state of one channel, filled in during a scan and published when the scan completes
+struct ChannelState {
+  int8_t element{ELEMENT_UNKNOWN};
+  bool output_on{false};
+  float temperature{NAN};
+  int battery{0};
+  float target_temp{NAN};
+  int mode{0};
+  uint8_t updated{0};
+  // fields that have been read at least once, and the scan in which each field was last read
+  uint8_t seen{0};
+  uint32_t last_read[FIELD_COUNT]{};
+  // adaptive interval of the temperature reads, 0 is the shortest one
+  uint32_t temperature_interval{0};
+  // values last published to the channel binding
+  int8_t published_output{-1};
+  float published_temperature{NAN};
+  int published_battery{-1};
+  float published_target_temp{NAN};
+  int published_mode{-1};
+  uint32_t last_heartbeat{0};
+};
+
+// Transaction counters of one channel and their optional diagnostic sensors
+struct ChannelStats {
+  uint32_t requests{0};
+  uint32_t timeouts{0};
+  uint32_t last_success{0};
+  sensor::Sensor *requests_sensor{nullptr};
+  sensor::Sensor *timeouts_sensor{nullptr};
+  sensor::Sensor *last_success_age_sensor{nullptr};
+};
+
+// Receives the published values of one channel, implemented by the climate of that channel
+class WavinChannelListener {
+  public:
+    virtual ~WavinChannelListener() = default;
+    virtual void on_output(bool /*on*/) {}
+    virtual void on_temperature(float /*temperature*/) {}
+    virtual void on_target_temp(float /*temperature*/) {}
+    virtual void on_mode(int /*mode*/) {}
+};
+
+// Where the values of one channel go. Bound once at startup, so publishing a value is a pointer check and a call.
+struct ChannelBinding {
+  WavinChannelListener *listener{nullptr};
+  sensor::Sensor *temperature_sensor{nullptr};
+  sensor::Sensor *battery_sensor{nullptr};
+};
+
+// Channel to primary element map, persisted so known unused channels can be skipped right after boot
+struct WavinTopology {
+  int8_t element[16];
+};
+
+class WavinAhc9000;
+
+// Hands the RS-485 line to one hub at a time when several controllers share a modbus component. The hubs take turns
+// per transaction, so their scans progress side by side instead of one after the other.
+class WavinBusArbiter {
+  public:
+    static WavinBusArbiter *for_bus(modbus::Modbus *bus);
+    void add(WavinAhc9000 *hub) { hubs_.push_back(hub); }
+    bool acquire(WavinAhc9000 *hub);
+    void release(WavinAhc9000 *hub);
+
+  protected:
+    explicit WavinBusArbiter(modbus::Modbus *bus) : bus_(bus) {}
+
+    modbus::Modbus *bus_;
+    std::vector<WavinAhc9000 *> hubs_;
+    WavinAhc9000 *owner_{nullptr};
+    // hubs with a transaction ready, bit n is hubs_[n]
+    uint32_t waiting_{0};
+    size_t turn_{0};
+};
+
 class WavinAhc9000 : public PollingComponent, public modbus::ModbusDevice {
   public:
     void setup();
@@ -14,33 +110,145 @@ class WavinAhc9000 : public PollingComponent, public modbus::ModbusDevice {
     void on_modbus_data(const std::vector<uint8_t> &data) override;
 
     void set_rw_pin(GPIOPin *pin) { rw_pin_ = pin; }
-    void add_temp_callback(int channel, std::function<void(float)> &&callback);
-    void add_bat_level_callback(int channel, std::function<void(float)> &&callback);
-    void add_target_temp_callback(int channel, std::function<void(float)> &&callback);
-    void add_mode_callback(int channel, std::function<void(int)> &&callback);
-    void add_output_callback(int channel, std::function<void(bool)> &&callback);
+    void set_baud_rate(uint32_t baud_rate) { baud_rate_ = baud_rate; }
+    void set_rediscovery_interval(uint32_t interval) { rediscovery_interval_ = interval; }
+    void set_min_timeout(uint32_t timeout) { min_timeout_ = timeout; }
+    void set_max_timeout(uint32_t timeout) { max_timeout_ = timeout; }
+    void set_retries(uint8_t retries) { retries_ = retries; }
+    void set_temperature_deadband(float deadband) { temperature_deadband_ = deadband; }
+    void set_heartbeat(uint32_t heartbeat) { heartbeat_ = heartbeat; }
+    void set_output_interval(uint32_t interval) { field_interval_[0] = interval; }
+    void set_temperature_interval(uint32_t interval) { field_interval_[1] = interval; }
+    void set_temperature_max_interval(uint32_t interval) { temperature_max_interval_ = interval; }
+    void set_battery_interval(uint32_t interval) { field_interval_[2] = interval; }
+    void set_setpoint_interval(uint32_t interval) { field_interval_[3] = interval; }
+    void set_mode_interval(uint32_t interval) { field_interval_[4] = interval; }
+    void set_write_refresh_delay(uint32_t delay) { write_refresh_delay_ = delay; }
+    void set_requests_sensor(sensor::Sensor *sensor) { requests_sensor_ = sensor; }
+    void set_timeouts_sensor(sensor::Sensor *sensor) { timeouts_sensor_ = sensor; }
+    void set_invalid_replies_sensor(sensor::Sensor *sensor) { invalid_replies_sensor_ = sensor; }
+    void set_rtt_mean_sensor(sensor::Sensor *sensor) { rtt_mean_sensor_ = sensor; }
+    void set_rtt_max_sensor(sensor::Sensor *sensor) { rtt_max_sensor_ = sensor; }
+    void set_scan_duration_sensor(sensor::Sensor *sensor) { scan_duration_sensor_ = sensor; }
+    void set_last_success_age_sensor(sensor::Sensor *sensor) { last_success_age_sensor_ = sensor; }
+    void set_channel_requests_sensor(int channel, sensor::Sensor *sensor) {
+      channel_stats_[channel].requests_sensor = sensor;
+    }
+    void set_channel_timeouts_sensor(int channel, sensor::Sensor *sensor) {
+      channel_stats_[channel].timeouts_sensor = sensor;
+    }
+    void set_channel_last_success_age_sensor(int channel, sensor::Sensor *sensor) {
+      channel_stats_[channel].last_success_age_sensor = sensor;
+    }
+    void set_channel_listener(int channel, WavinChannelListener *listener) { bindings_[channel].listener = listener; }
+    void set_channel_temperature_sensor(int channel, sensor::Sensor *sensor) {
+      bindings_[channel].temperature_sensor = sensor;
+    }
+    void set_channel_battery_sensor(int channel, sensor::Sensor *sensor) { bindings_[channel].battery_sensor = sensor; }
     void set_target_temp(int channel, float temperature);
+    void set_mode(int channel, int mode);
+    void set_standby(int channel, bool standby);
+    void request_refresh(int channel, uint8_t fields, uint32_t delay = 0);
 
   private:
     void handle_channel_data_(const std::vector<uint8_t> &data);
     void handle_element_data_(const std::vector<uint8_t> &data);
-    void handle_target_temp_data_(const std::vector<uint8_t> &data);
-    void handle_mode_data_(const std::vector<uint8_t> &data);
+    void handle_packed_data_(const std::vector<uint8_t> &data);
+    void handle_write_data_(const std::vector<uint8_t> &data);
+    void publish_snapshot_();
+    void publish_output_(int channel);
+    void publish_temperature_(int channel);
+    void publish_battery_(int channel);
+    void publish_target_temp_(int channel);
+    void publish_mode_(int channel);
+    bool temperature_changed_(float value, float published) const;
+    int next_scan_channel_(int channel);
+    int next_pending_(uint16_t &pending);
+    void start_channel_(int channel);
+    uint8_t due_fields_(int channel) const;
+    uint32_t field_interval_of_(const ChannelState &ch, int field) const;
+    uint32_t temperature_min_interval_() const;
+    void adapt_temperature_interval_(ChannelState &ch, float change, uint32_t elapsed);
+    bool state_due_(int state) const;
+    void mark_read_(ChannelState &ch, uint8_t fields);
+    void transmit_request_();
+    int transaction_channel_() const;
+    void publish_diagnostics_();
+    void update_timeout_(uint32_t rtt_us);
+    void begin_transmit_();
+    void end_transmit_(size_t frame_length);
+    void load_topology_();
+    void save_topology_();
 
-    GPIOPin *rw_pin_;
+    WavinBusArbiter *arbiter_{nullptr};
+    GPIOPin *rw_pin_{nullptr};
+    uint32_t baud_rate_{38400};
+    uint32_t char_time_us_{0};
+#ifdef USE_ESP32
+    static void release_rw_pin_(void *arg);
+    ISRInternalGPIOPin rw_isr_pin_;
+    esp_timer_handle_t rw_timer_{nullptr};
+#endif
     int channel_ = -1;
     int state_ = 0;
-    int element_ = 0;
     bool start_scan_ = false;
+    uint32_t scan_start_ = 0;
+    uint8_t due_ = 0;
+    uint8_t read_count_ = 0;
+    uint32_t field_interval_[FIELD_COUNT]{};
+    uint32_t temperature_max_interval_ = 0;
+    bool refresh_scan_ = false;
+    uint16_t pending_refreshes_ = 0;
+    uint8_t refresh_fields_[16]{};
+    uint32_t refresh_at_ = 0;
+    uint32_t write_refresh_delay_ = 1000;
+    bool discovery_scan_ = false;
+    bool topology_dirty_ = false;
+    uint32_t last_discovery_ = 0;
+    uint32_t rediscovery_interval_ = 3600000;
+    ESPPreferenceObject topology_pref_;
     bool waiting_ = false;
-    std::vector<float> set_temp_;
-    std::vector<float> temp_channel_;
-
-    CallbackManager<void(float)> temp_callbacks_[16];
-    CallbackManager<void(float)> bat_level_callbacks_[16];
-    CallbackManager<void(float)> target_temp_callbacks_[16];
-    CallbackManager<void(int)> mode_callbacks_[16];
-    CallbackManager<void(bool)> output_callbacks_[16];
+    // after a timeout, nothing is sent until guard_start_us_ + timeout_us_
+    bool guarding_ = false;
+    uint32_t guard_start_us_ = 0;
+    // registers in the reply to the request in flight
+    uint8_t reply_count_ = 0;
+    int write_channel_ = -1;
+    int write_value_ = 0;
+    uint8_t write_kind_ = 0;
+    uint8_t attempts_ = 0;
+    uint8_t retries_ = 2;
+    uint32_t last_send_us_ = 0;
+    uint32_t min_timeout_ = 50;
+    uint32_t max_timeout_ = 1000;
+    uint32_t timeout_us_ = 1000000;
+    uint32_t srtt_us_ = 0;
+    uint32_t rttvar_us_ = 0;
+    float temperature_deadband_ = 0;
+    uint32_t heartbeat_ = 0;
+    uint16_t pending_setpoints_ = 0;
+    int16_t pending_setpoint_[16];
+    uint16_t pending_modes_ = 0;
+    uint8_t pending_mode_[16];
+    ChannelState channels_[16];
+
+    // diagnostics
+    uint32_t requests_ = 0;
+    uint32_t timeouts_ = 0;
+    uint32_t invalid_replies_ = 0;
+    uint32_t rtt_max_us_ = 0;
+    uint32_t scan_duration_ = 0;
+    uint32_t last_success_ = 0;
+    ChannelStats channel_stats_[16];
+    sensor::Sensor *requests_sensor_{nullptr};
+    sensor::Sensor *timeouts_sensor_{nullptr};
+    sensor::Sensor *invalid_replies_sensor_{nullptr};
+    sensor::Sensor *rtt_mean_sensor_{nullptr};
+    sensor::Sensor *rtt_max_sensor_{nullptr};
+    sensor::Sensor *scan_duration_sensor_{nullptr};
+    sensor::Sensor *last_success_age_sensor_{nullptr};
+
+    ChannelBinding bindings_[16];
 };
 }
 }
@@ -0,0 +1,4 @@
+import esphome.config_validation as cv
+
+# Header only Wavin AHC 9000 protocol codec, loaded by the wavinAhc9000 and wavinahc9000v2 components
+CONFIG_SCHEMA = cv.Schema({})
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Frames of the Wavin AHC 9000 modbus dialect. A request addresses one register page:
+//   read:         address, 0x43, category, index, page, count, crc
+//   write:        address, 0x44, category, index, page, count, value, crc
+//   masked write: address, 0x45, category, index, page, count, value, mask, crc
+// The masked write stores (current & mask) | (value & ~mask). Values, masks and the register data of a reply are
+// big endian words, the crc is the standard modbus crc16 sent low byte first.
+
+namespace esphome {
+namespace wavin_protocol {
+
+static const uint8_t FUNCTION_READ = 0x43;
+static const uint8_t FUNCTION_WRITE = 0x44;
+static const uint8_t FUNCTION_WRITE_MASKED = 0x45;
+
+static const uint8_t CATEGORY_MAIN = 0x00;
+static const uint8_t CATEGORY_ELEMENTS = 0x01;
+static const uint8_t CATEGORY_PACKED_DATA = 0x02;
+static const uint8_t CATEGORY_CHANNELS = 0x03;
+
+static const uint8_t ELEMENTS_AIR_TEMPERATURE = 0x04;
+static const uint8_t ELEMENTS_FLOOR_TEMPERATURE = 0x05;
+static const uint8_t ELEMENTS_BATTERY = 0x0A;
+
+static const uint8_t PACKED_DATA_MANUAL_TEMPERATURE = 0x00;
+static const uint8_t PACKED_DATA_COMFORT_TEMPERATURE = 0x01;
+static const uint8_t PACKED_DATA_CONFIGURATION = 0x07;
+
+static const uint8_t CHANNELS_TIMER_EVENT = 0x00;
+static const uint8_t CHANNELS_PRIMARY_ELEMENT = 0x02;
+
+// Bits of the registers above
+static const uint16_t TIMER_EVENT_OUTP_ON = 0x0010;
+static const uint16_t PRIMARY_ELEMENT_MASK = 0x003f;
+static const uint16_t PRIMARY_ELEMENT_ALL_TP_LOST = 0x0400;
+static const uint16_t CONFIGURATION_MODE_MASK = 0x0007;
+static const uint16_t CONFIGURATION_MODE_MANUAL = 0x0000;
+static const uint16_t CONFIGURATION_MODE_STANDBY = 0x0001;
+
+// Frame lengths including the crc
+static const size_t READ_FRAME_LENGTH = 8;
+static const size_t WRITE_FRAME_LENGTH = 10;
+static const size_t MASKED_WRITE_FRAME_LENGTH = 12;
+
+struct Crc16Table {
+  uint16_t entry[256];
+};
+
+constexpr Crc16Table make_crc16_table() {
+  Crc16Table table{};
+  for (uint16_t i = 0; i < 256; i++) {
+    uint16_t crc = i;
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = (crc & 0x01) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    table.entry[i] = crc;
+  }
+  return table;
+}
+
+// 512 bytes of flash, one lookup per byte instead of eight shifts
+inline constexpr Crc16Table CRC16_TABLE = make_crc16_table();
+
+constexpr uint16_t crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--)
+    crc = (crc >> 8) ^ CRC16_TABLE.entry[(crc ^ *data++) & 0xff];
+  return crc;
+}
+
+// The builders below return the frame without crc, as modbus_controller custom commands and write lambdas expect it.
+// with_crc() turns one into a complete frame for writing to the uart directly.
+constexpr std::array<uint8_t, READ_FRAME_LENGTH - 2> read_payload(uint8_t address, uint8_t category, uint8_t index,
+                                                                   uint8_t page, uint8_t count) {
+  return {address, FUNCTION_READ, category, index, page, count};
+}
+
+constexpr std::array<uint8_t, WRITE_FRAME_LENGTH - 2> write_payload(uint8_t address, uint8_t category, uint8_t index,
+                                                                     uint8_t page, uint16_t value) {
+  return {address, FUNCTION_WRITE, category, index, page, 1, (uint8_t) (value >> 8), (uint8_t) (value & 0xff)};
+}
+
+constexpr std::array<uint8_t, MASKED_WRITE_FRAME_LENGTH - 2> masked_write_payload(uint8_t address, uint8_t category,
+                                                                                   uint8_t index, uint8_t page,
+                                                                                   uint16_t value, uint16_t mask) {
+  return {address, FUNCTION_WRITE_MASKED, category, index, page, 1,
+          (uint8_t) (value >> 8), (uint8_t) (value & 0xff), (uint8_t) (mask >> 8), (uint8_t) (mask & 0xff)};
+}
+
+template<size_t N> constexpr std::array<uint8_t, N + 2> with_crc(const std::array<uint8_t, N> &payload) {
+  std::array<uint8_t, N + 2> frame{};
+  for (size_t i = 0; i < N; i++)
+    frame[i] = payload[i];
+  uint16_t crc = crc16(payload.data(), N);
+  frame[N] = crc & 0xff;
+  frame[N + 1] = crc >> 8;
+  return frame;
+}
+
+constexpr std::array<uint8_t, READ_FRAME_LENGTH> read_frame(uint8_t address, uint8_t category, uint8_t index,
+                                                            uint8_t page, uint8_t count) {
+  return with_crc(read_payload(address, category, index, page, count));
+}
+
+constexpr std::array<uint8_t, WRITE_FRAME_LENGTH> write_frame(uint8_t address, uint8_t category, uint8_t index,
+                                                              uint8_t page, uint16_t value) {
+  return with_crc(write_payload(address, category, index, page, value));
+}
+
+constexpr std::array<uint8_t, MASKED_WRITE_FRAME_LENGTH> masked_write_frame(uint8_t address, uint8_t category,
+                                                                            uint8_t index, uint8_t page,
+                                                                            uint16_t value, uint16_t mask) {
+  return with_crc(masked_write_payload(address, category, index, page, value, mask));
+}
+
+// Big endian word pairs of a payload, for number write lambdas whose payload is a list of words
+template<size_t N> constexpr std::array<uint16_t, N / 2> to_words(const std::array<uint8_t, N> &payload) {
+  static_assert(N % 2 == 0, "payload must be a whole number of words");
+  std::array<uint16_t, N / 2> words{};
+  for (size_t i = 0; i < N / 2; i++)
+    words[i] = (payload[2 * i] << 8) | payload[2 * i + 1];
+  return words;
+}
+
+// Register data of a reply without copying it, as handed to ModbusDevice::on_modbus_data or a modbus_controller
+// lambda. The view doesn't own the data, so it must not outlive the buffer.
+class RegisterView {
+ public:
+  constexpr RegisterView(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+  RegisterView(const std::vector<uint8_t> &data) : data_(data.data()), size_(data.size()) {}
+
+  constexpr size_t count() const { return size_ / 2; }
+  constexpr bool has(size_t count) const { return size_ >= count * 2; }
+  constexpr uint16_t word(size_t index) const { return (data_[2 * index] << 8) | data_[2 * index + 1]; }
+  constexpr uint8_t low(size_t index) const { return data_[2 * index + 1]; }
+
+ protected:
+  const uint8_t *data_;
+  size_t size_;
+};
+
+}  // namespace wavin_protocol
+}  // namespace esphome
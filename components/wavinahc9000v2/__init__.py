@@ -2,6 +2,8 @@ import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.const import CONF_ID
 
+AUTO_LOAD = ['wavin_protocol']
+
 wavinahc9000v2_ns = cg.esphome_ns.namespace('wavinahc9000v2')
 Wavinahc9000v2 = wavinahc9000v2_ns.class_('Wavinahc9000v2', cg.Component)
 
@@ -1,31 +1,23 @@
 #pragma once
 
 #include "esphome/core/component.h"
-#include "esphome/components/climate/climate.h"
-#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/register_climate/register_climate.h"
 #include "esphome/components/binary_sensor/binary_sensor.h"
-#include "esphome/components/number/number.h"
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/modbus_controller/modbus_controller.h"
 
 namespace esphome {
 namespace wavinahc9000v2 {
-class Wavinahc9000v2Climate : public climate::Climate, public Component {
+
+using register_climate::ModeMapping;
+
+class Wavinahc9000v2Climate : public register_climate::RegisterClimate<Wavinahc9000v2Climate> {
 public:
 
   Wavinahc9000v2Climate() {}
 
-  void setup() override;
   void dump_config() override;
 
-  void set_current_temp_sensor(sensor::Sensor *sensor) {
-    this->current_temp_sensor_ = sensor;
-  }
-
-  void set_temp_setpoint_number(number::Number *number) {
-    this->temp_setpoint_number_ = number;
-  }
-
   void set_mode_switch(switch_::Switch *switch_) {
     this->mode_switch_ = switch_;
   }
@@ -34,27 +26,26 @@ public:
     this->hvac_action_ = binary_sensor;
   }
 
+  /// Standby switch state to climate mode
+  static constexpr std::array<ModeMapping, 2> MODES{{
+    {0, climate::CLIMATE_MODE_AUTO},
+    {1, climate::CLIMATE_MODE_OFF},
+  }};
+  static constexpr climate::ClimateMode FALLBACK_MODE = climate::CLIMATE_MODE_OFF;
 
 protected:
-  /// Override control to change settings of the climate device.
-  void control(const climate::ClimateCall& call) override;
-
-  /// Return the traits of this controller.
-  climate::ClimateTraits traits() override;
+  friend class register_climate::RegisterClimate<Wavinahc9000v2Climate>;
 
-  /// The sensor used for getting the current temperature
-  sensor::Sensor *current_temp_sensor_{ nullptr };
-
-  /// The number component used for getting the temperature setpoint
-  number::Number *temp_setpoint_number_{ nullptr };
+  void build_traits(climate::ClimateTraits &traits);
+  void bind_mode_source();
+  void write_mode(climate::ClimateMode mode);
+  float target_to_register(float target) const;
 
   /// The select component used for getting the operation mode
   switch_::Switch *mode_switch_{ nullptr };
 
   /// The select component used for getting the current action
   binary_sensor::BinarySensor *hvac_action_{ nullptr };
-
-private:
 };
 } // namespace wavinahc9000v2
 } // namespace esphome
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "esphome/core/component.h"
+// the frame builders are used by the write lambdas in configs/channel_*.yaml
+#include "esphome/components/wavin_protocol/wavin_protocol.h"
 
 namespace esphome {
 namespace wavinahc9000v2 {
@@ -0,0 +1,83 @@
+// Host benchmark of the Wavin AHC 9000 codec in components/wavin_protocol.
+//   g++ -std=gnu++17 -O2 -I components tools/wavin_protocol_bench.cpp -o wavin_protocol_bench
+// Compares the table driven crc16 against the bitwise one the drivers used before, and times the frame builders.
+// Host numbers only rank the variants, they are not what an ESP32 achieves.
+
+#include <chrono>
+#include <cstdio>
+
+#include "wavin_protocol/wavin_protocol.h"
+
+using namespace esphome::wavin_protocol;
+
+static const int ITERATIONS = 10000000;
+
+static uint16_t crc16_bitwise(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      if ((crc & 0x01) != 0) {
+        crc >>= 1;
+        crc ^= 0xA001;
+      } else {
+        crc >>= 1;
+      }
+    }
+  }
+  return crc;
+}
+
+// Keeps the compiler from dropping the benchmarked work
+static volatile uint32_t sink;
+
+template<typename F> static void run(const char *name, size_t bytes, F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  uint32_t acc = 0;
+  for (int i = 0; i < ITERATIONS; i++)
+    acc += f(i);
+  auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  sink = acc;
+  printf("%-28s %7.2f ns/op %7.2f ns/byte\n", name, ns / ITERATIONS, ns / ITERATIONS / bytes);
+}
+
+int main() {
+  // a reply to a packed data read of 8 registers is the largest frame the driver sees
+  uint8_t reply[3 + 16];
+  for (size_t i = 0; i < sizeof(reply); i++)
+    reply[i] = i * 37;
+
+  static_assert(read_frame(0x01, CATEGORY_CHANNELS, CHANNELS_TIMER_EVENT, 0, 3)[6] == 0x04, "crc low byte");
+  static_assert(read_frame(0x01, CATEGORY_CHANNELS, CHANNELS_TIMER_EVENT, 0, 3)[7] == 0x40, "crc high byte");
+  for (size_t len = 1; len <= sizeof(reply); len++) {
+    if (crc16(reply, len) != crc16_bitwise(reply, len)) {
+      printf("crc mismatch at length %zu\n", len);
+      return 1;
+    }
+  }
+
+  run("crc16 bitwise (19 bytes)", sizeof(reply), [&](int i) {
+    reply[0] = i;
+    return crc16_bitwise(reply, sizeof(reply));
+  });
+  run("crc16 table (19 bytes)", sizeof(reply), [&](int i) {
+    reply[0] = i;
+    return crc16(reply, sizeof(reply));
+  });
+  run("read_frame", READ_FRAME_LENGTH, [](int i) {
+    return read_frame(0x01, CATEGORY_PACKED_DATA, PACKED_DATA_MANUAL_TEMPERATURE, i & 0x0f, 8)[7];
+  });
+  run("write_frame", WRITE_FRAME_LENGTH, [](int i) {
+    return write_frame(0x01, CATEGORY_PACKED_DATA, PACKED_DATA_MANUAL_TEMPERATURE, i & 0x0f, i)[9];
+  });
+  run("masked_write_frame", MASKED_WRITE_FRAME_LENGTH, [](int i) {
+    return masked_write_frame(0x01, CATEGORY_PACKED_DATA, PACKED_DATA_CONFIGURATION, i & 0x0f, i & 1,
+                              ~CONFIGURATION_MODE_MASK)[11];
+  });
+  run("RegisterView decode", 16, [&](int i) {
+    reply[3] = i;
+    RegisterView regs(reply + 3, 16);
+    return regs.word(PACKED_DATA_MANUAL_TEMPERATURE) + (regs.word(PACKED_DATA_CONFIGURATION) & CONFIGURATION_MODE_MASK);
+  });
+  return 0;
+}
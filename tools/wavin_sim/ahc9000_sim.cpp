@@ -0,0 +1,151 @@
+#include "ahc9000_sim.h"
+
+#include "wavin_protocol/wavin_protocol.h"
+
+namespace wavin_sim {
+
+using namespace esphome::wavin_protocol;
+
+// 38400 baud 8N1
+static const uint64_t CHAR_TIME_US = 10 * 1000000 / 38400;
+
+uint64_t Ahc9000Sim::airtime_us(size_t len) { return len * CHAR_TIME_US; }
+
+void SimLine::transmit(const uint8_t *frame, size_t len, uint64_t now_us) {
+  stats_.frames++;
+  stats_.busy_us += Ahc9000Sim::airtime_us(len);
+  if (now_us < free_us_) {
+    stats_.collisions++;
+    return;
+  }
+  free_us_ = now_us + Ahc9000Sim::airtime_us(len);
+  for (auto *sim : sims_) {
+    if (len > 0 && frame[0] == sim->address())
+      sim->receive(frame, len, free_us_);
+  }
+}
+
+uint64_t SimLine::reserve(uint64_t start_us, size_t len) {
+  stats_.frames++;
+  stats_.busy_us += Ahc9000Sim::airtime_us(len);
+  free_us_ = std::max(start_us, free_us_) + Ahc9000Sim::airtime_us(len);
+  return free_us_;
+}
+
+Ahc9000Sim::Ahc9000Sim(const SimConfig &config, SimLine *line) : config_(config), line_(line), rng_(config.seed) {
+  line->attach(this);
+  for (int channel = 0; channel < CHANNELS; channel++) {
+    if (!is_used(channel))
+      continue;
+    int element = element_of(channel);
+    channels_[channel][CHANNELS_PRIMARY_ELEMENT] = element + 1;
+    elements_[element][ELEMENTS_AIR_TEMPERATURE] = 200 + channel;
+    elements_[element][ELEMENTS_BATTERY] = 10;
+    packed_[channel][PACKED_DATA_MANUAL_TEMPERATURE] = 210;
+    packed_[channel][PACKED_DATA_COMFORT_TEMPERATURE] = 220;
+    packed_[channel][PACKED_DATA_CONFIGURATION] = CONFIGURATION_MODE_MANUAL;
+  }
+}
+
+void Ahc9000Sim::set_output(int channel, bool on) {
+  if (on)
+    channels_[channel][CHANNELS_TIMER_EVENT] |= TIMER_EVENT_OUTP_ON;
+  else
+    channels_[channel][CHANNELS_TIMER_EVENT] &= ~TIMER_EVENT_OUTP_ON;
+}
+
+// Registers index up to index + count - 1 of one page, or nullptr when they don't exist
+uint16_t *Ahc9000Sim::register_(uint8_t category, uint8_t index, uint8_t page, uint8_t count) {
+  switch (category) {
+    case CATEGORY_MAIN:
+      return (page == 0 && index + count <= 32) ? &main_[0][index] : nullptr;
+    case CATEGORY_ELEMENTS:
+      return (page < ELEMENTS && index + count <= 13) ? &elements_[page][index] : nullptr;
+    case CATEGORY_PACKED_DATA:
+      return (page <= CHANNELS && index + count <= 17) ? &packed_[page][index] : nullptr;
+    case CATEGORY_CHANNELS:
+      return (page <= CHANNELS && index + count <= 4) ? &channels_[page][index] : nullptr;
+  }
+  return nullptr;
+}
+
+void Ahc9000Sim::receive(const uint8_t *frame, size_t len, uint64_t end_us) {
+  stats_.requests++;
+  if (len < READ_FRAME_LENGTH ||
+      crc16(frame, len - 2) != (frame[len - 2] | (frame[len - 1] << 8))) {
+    stats_.malformed++;
+    return;
+  }
+  if (std::uniform_real_distribution<double>(0, 1)(rng_) < config_.drop_rate) {
+    stats_.dropped++;
+    return;
+  }
+  uint8_t function = frame[1], category = frame[2], index = frame[3], page = frame[4], count = frame[5];
+  uint16_t *regs = register_(category, index, page, count);
+  if (regs == nullptr || count == 0) {
+    stats_.malformed++;
+    return;
+  }
+  std::vector<uint8_t> payload;
+  switch (function) {
+    case FUNCTION_READ:
+      for (int i = 0; i < count; i++) {
+        payload.push_back(regs[i] >> 8);
+        payload.push_back(regs[i] & 0xff);
+      }
+      break;
+    case FUNCTION_WRITE:
+      if (len != WRITE_FRAME_LENGTH) {
+        stats_.malformed++;
+        return;
+      }
+      regs[0] = (frame[6] << 8) | frame[7];
+      payload = {frame[6], frame[7]};
+      break;
+    case FUNCTION_WRITE_MASKED: {
+      if (len != MASKED_WRITE_FRAME_LENGTH) {
+        stats_.malformed++;
+        return;
+      }
+      uint16_t value = (frame[6] << 8) | frame[7];
+      uint16_t mask = (frame[8] << 8) | frame[9];
+      regs[0] = (regs[0] & mask) | (value & ~mask);
+      payload = {(uint8_t) (regs[0] >> 8), (uint8_t) (regs[0] & 0xff)};
+      break;
+    }
+    default:
+      stats_.malformed++;
+      return;
+  }
+  reply_(end_us, function, std::move(payload));
+}
+
+void Ahc9000Sim::reply_(uint64_t request_end_us, uint8_t function, std::vector<uint8_t> &&payload) {
+  std::vector<uint8_t> frame{config_.address, function, (uint8_t) payload.size()};
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  uint16_t crc = crc16(frame.data(), frame.size());
+  if (std::uniform_real_distribution<double>(0, 1)(rng_) < config_.crc_error_rate) {
+    crc ^= 0x5555;
+    stats_.corrupted++;
+  }
+  frame.push_back(crc & 0xff);
+  frame.push_back(crc >> 8);
+  uint32_t latency = std::uniform_int_distribution<uint32_t>(config_.min_latency_us, config_.max_latency_us)(rng_);
+  uint64_t arrival_us = line_->reserve(request_end_us + latency, frame.size());
+  pending_.push_back({arrival_us, std::move(frame)});
+}
+
+void Ahc9000Sim::deliver(uint64_t now_us, const std::function<void(const std::vector<uint8_t> &)> &callback) {
+  while (!pending_.empty() && pending_.front().arrival_us <= now_us) {
+    std::vector<uint8_t> frame = std::move(pending_.front().frame);
+    pending_.erase(pending_.begin());
+    // the modbus component drops frames that fail the crc check, the driver only sees a timeout
+    size_t len = frame.size();
+    if (crc16(frame.data(), len - 2) != (frame[len - 2] | (frame[len - 1] << 8)))
+      continue;
+    stats_.replies++;
+    callback(std::vector<uint8_t>(frame.begin() + 3, frame.end() - 2));
+  }
+}
+
+}  // namespace wavin_sim
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+// Simulated Wavin AHC 9000 controllers on an in-process RS-485 line. Each answers the 0x43 read, 0x44 write and
+// 0x45 masked write requests of the codec in components/wavin_protocol for its own address from a register model,
+// with configurable reply latency, dropped requests and corrupted replies.
+
+namespace wavin_sim {
+
+static const int CHANNELS = 16;
+static const int ELEMENTS = 48;
+
+struct SimConfig {
+  uint8_t address{0x01};
+  // channels with a thermostat, bit n is channel n + 1
+  uint16_t population{0x00ff};
+  uint32_t min_latency_us{5000};
+  uint32_t max_latency_us{15000};
+  // probability that a request gets no reply, and that a reply fails the crc check
+  double drop_rate{0.0};
+  double crc_error_rate{0.0};
+  uint32_t seed{1};
+};
+
+struct BusStats {
+  uint32_t requests{0};
+  uint32_t replies{0};
+  uint32_t dropped{0};
+  uint32_t corrupted{0};
+  uint32_t malformed{0};
+};
+
+struct LineStats {
+  uint32_t frames{0};
+  // requests sent while another frame was still on the line, they are lost
+  uint32_t collisions{0};
+  // time the line carries a frame in either direction
+  uint64_t busy_us{0};
+};
+
+class Ahc9000Sim;
+
+// The shared half duplex line, frames written by a driver reach every controller on it
+class SimLine {
+ public:
+  void attach(Ahc9000Sim *sim) { sims_.push_back(sim); }
+  void transmit(const uint8_t *frame, size_t len, uint64_t now_us);
+  // Puts a reply on the line no earlier than start_us and returns the time it has completely arrived
+  uint64_t reserve(uint64_t start_us, size_t len);
+  const LineStats &stats() const { return stats_; }
+
+ protected:
+  std::vector<Ahc9000Sim *> sims_;
+  uint64_t free_us_{0};
+  LineStats stats_;
+};
+
+class Ahc9000Sim {
+ public:
+  Ahc9000Sim(const SimConfig &config, SimLine *line);
+
+  uint8_t address() const { return config_.address; }
+  // Takes a request addressed to this controller that has completely arrived at the given time
+  void receive(const uint8_t *frame, size_t len, uint64_t end_us);
+  // Hands replies that have completely arrived by now to the callback, without address, function and byte count
+  void deliver(uint64_t now_us, const std::function<void(const std::vector<uint8_t> &)> &callback);
+
+  bool is_used(int channel) const { return config_.population & (1 << channel); }
+  int element_of(int channel) const { return channel; }
+
+  // Register model, in the units of the controller
+  uint16_t air_temperature(int channel) const { return elements_[element_of(channel)][0x04]; }
+  void set_air_temperature(int channel, uint16_t value) { elements_[element_of(channel)][0x04] = value; }
+  bool output(int channel) const { return channels_[channel][0x00] & 0x0010; }
+  void set_output(int channel, bool on);
+  uint16_t manual_temperature(int channel) const { return packed_[channel][0x00]; }
+
+  const BusStats &stats() const { return stats_; }
+  static uint64_t airtime_us(size_t len);
+
+ protected:
+  struct PendingReply {
+    uint64_t arrival_us;
+    std::vector<uint8_t> frame;
+  };
+
+  uint16_t *register_(uint8_t category, uint8_t index, uint8_t page, uint8_t count);
+  void reply_(uint64_t request_end_us, uint8_t function, std::vector<uint8_t> &&payload);
+
+  SimConfig config_;
+  SimLine *line_;
+  std::mt19937 rng_;
+  BusStats stats_;
+  std::vector<PendingReply> pending_;
+  uint16_t main_[1][32]{};
+  uint16_t elements_[ELEMENTS][13]{};
+  uint16_t packed_[CHANNELS + 1][17]{};
+  uint16_t channels_[CHANNELS + 1][4]{};
+};
+
+}  // namespace wavin_sim
@@ -0,0 +1,35 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace modbus {
+
+// Bus end of the simulation: frames written by the driver go to the simulated controller
+class Modbus : public Component {
+ public:
+  void set_transmit_callback(std::function<void(const uint8_t *, size_t)> &&callback) {
+    transmit_callback_ = std::move(callback);
+  }
+  void write_array(const uint8_t *data, size_t len) { transmit_callback_(data, len); }
+  void flush() {}
+
+ protected:
+  std::function<void(const uint8_t *, size_t)> transmit_callback_;
+};
+
+class ModbusDevice {
+ public:
+  void set_parent(Modbus *parent) { parent_ = parent; }
+  void set_address(uint8_t address) { address_ = address; }
+  virtual void on_modbus_data(const std::vector<uint8_t> &data) = 0;
+
+ protected:
+  Modbus *parent_{nullptr};
+  uint8_t address_{0};
+};
+
+}  // namespace modbus
+}  // namespace esphome
@@ -0,0 +1,2 @@
+#pragma once
+#include "wavin_protocol/wavin_protocol.h"
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+// Virtual clock of the simulation, advanced by the benchmark loop
+namespace esphome {
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+namespace gpio {
+enum Flags { FLAG_INPUT = 0x01, FLAG_OUTPUT = 0x02 };
+}
+
+class GPIOPin {
+ public:
+  virtual bool is_internal() { return false; }
+  void pin_mode(gpio::Flags flags) {}
+  void digital_write(bool value) {}
+};
+
+class InternalGPIOPin : public GPIOPin {
+ public:
+  bool is_internal() override { return true; }
+};
+}  // namespace esphome
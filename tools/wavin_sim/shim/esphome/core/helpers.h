@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "esphome/core/component.h"
+
+#define ONOFF(b) ((b) ? "ON" : "OFF")
+
+namespace esphome {
+
+template<typename... X> class CallbackManager;
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &callback : callbacks_)
+      callback(args...);
+  }
+
+ protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+std::string hexencode(const std::vector<uint8_t> &data);
+uint32_t fnv1_hash(const std::string &str);
+
+}  // namespace esphome
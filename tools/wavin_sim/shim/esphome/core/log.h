@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdio>
+
+// Driver logging is compiled out unless WAVIN_SIM_LOG is defined, so it doesn't skew the timing
+#ifdef WAVIN_SIM_LOG
+#define ESP_LOGW(tag, ...) (printf("[W][%s] ", tag), printf(__VA_ARGS__), printf("\n"))
+#define ESP_LOGD(tag, ...) (printf("[D][%s] ", tag), printf(__VA_ARGS__), printf("\n"))
+#else
+#define ESP_LOGW(tag, ...) ((void) 0)
+#define ESP_LOGD(tag, ...) ((void) 0)
+#endif
+#define ESP_LOGE ESP_LOGW
+#define ESP_LOGI ESP_LOGD
+#define ESP_LOGV(tag, ...) ((void) 0)
+#define ESP_LOGVV(tag, ...) ((void) 0)
+#define ESP_LOGCONFIG ESP_LOGD
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+// In memory preferences, kept for the lifetime of the process
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  explicit ESPPreferenceObject(std::vector<uint8_t> *storage) : storage_(storage) {}
+
+  template<typename T> bool save(const T *src) {
+    if (storage_ == nullptr)
+      return false;
+    storage_->assign(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<const uint8_t *>(src) + sizeof(T));
+    return true;
+  }
+  template<typename T> bool load(T *dest) {
+    if (storage_ == nullptr || storage_->size() != sizeof(T))
+      return false;
+    memcpy(dest, storage_->data(), sizeof(T));
+    return true;
+  }
+
+ protected:
+  std::vector<uint8_t> *storage_{nullptr};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type) { return ESPPreferenceObject(&store_[type]); }
+
+ protected:
+  std::map<uint32_t, std::vector<uint8_t>> store_;
+};
+
+extern ESPPreferences *global_preferences;
+
+}  // namespace esphome
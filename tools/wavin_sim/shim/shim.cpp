@@ -0,0 +1,35 @@
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
+
+namespace esphome {
+
+uint64_t sim_now_us = 0;
+
+uint32_t millis() { return sim_now_us / 1000; }
+uint32_t micros() { return sim_now_us; }
+void delay(uint32_t ms) { sim_now_us += ms * 1000ULL; }
+
+std::string hexencode(const std::vector<uint8_t> &data) {
+  std::string out;
+  char buf[4];
+  for (uint8_t byte : data) {
+    snprintf(buf, sizeof(buf), "%02X.", byte);
+    out += buf;
+  }
+  return out;
+}
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= c;
+  }
+  return hash;
+}
+
+static ESPPreferences preferences;
+ESPPreferences *global_preferences = &preferences;
+
+}  // namespace esphome
@@ -0,0 +1,263 @@
+// Scan latency benchmark of the wavinAhc9000 driver against a simulated AHC 9000, on a virtual clock.
+//
+//   g++ -std=gnu++17 -O2 -I tools/wavin_sim/shim -I components -o wavin_scan_bench
+//       tools/wavin_sim/wavin_scan_bench.cpp tools/wavin_sim/ahc9000_sim.cpp tools/wavin_sim/shim/shim.cpp
+//       components/wavinAhc9000/wavinAhc9000.cpp
+//   ./wavin_scan_bench --duration=86400 --update-interval=10000 --output-interval=10000 --temperature-interval=60000
+//
+// Room temperatures and outputs change at random in the simulated controllers, which share one line at consecutive
+// addresses. Time to fresh data is the time from such a change until the driver publishes the new value.
+// Add -DWAVIN_SIM_LOG to see the driver log.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ahc9000_sim.h"
+#include "wavinAhc9000/wavinAhc9000.h"
+
+namespace esphome {
+extern uint64_t sim_now_us;
+}
+
+using esphome::sim_now_us;
+using namespace wavin_sim;
+
+static const uint64_t STEP_US = 100;
+
+struct Options {
+  SimConfig sim;
+  uint32_t duration_s{3600};
+  uint32_t update_interval_ms{60000};
+  double temperature_change_s{300};
+  double output_change_s{900};
+  uint32_t field_interval_ms[5]{};
+  uint32_t temperature_max_interval_ms{0};
+  uint32_t min_timeout_ms{50};
+  uint32_t max_timeout_ms{1000};
+  int retries{2};
+  int controllers{1};
+};
+
+static void usage() {
+  printf("options: --duration=s --update-interval=ms --controllers=n --population=mask --latency=min_us:max_us --drop=p --crc=p\n"
+         "         --seed=n --temperature-change=s --output-change=s --retries=n --min-timeout=ms --max-timeout=ms\n"
+         "         --output-interval=ms --temperature-interval=ms --battery-interval=ms --setpoint-interval=ms\n"
+         "         --mode-interval=ms --temperature-max-interval=ms\n");
+  exit(1);
+}
+
+static Options parse_options(int argc, char **argv) {
+  static const char *FIELD_OPTIONS[5] = {"output-interval", "temperature-interval", "battery-interval",
+                                         "setpoint-interval", "mode-interval"};
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+      usage();
+    std::string name = arg.substr(2, eq - 2);
+    const char *value = arg.c_str() + eq + 1;
+    if (name == "duration")
+      options.duration_s = atoi(value);
+    else if (name == "update-interval")
+      options.update_interval_ms = atoi(value);
+    else if (name == "population")
+      options.sim.population = strtoul(value, nullptr, 0);
+    else if (name == "latency" && strchr(value, ':'))
+      options.sim.min_latency_us = atoi(value), options.sim.max_latency_us = atoi(strchr(value, ':') + 1);
+    else if (name == "drop")
+      options.sim.drop_rate = atof(value);
+    else if (name == "crc")
+      options.sim.crc_error_rate = atof(value);
+    else if (name == "seed")
+      options.sim.seed = atoi(value);
+    else if (name == "temperature-change")
+      options.temperature_change_s = atof(value);
+    else if (name == "output-change")
+      options.output_change_s = atof(value);
+    else if (name == "controllers")
+      options.controllers = atoi(value);
+    else if (name == "retries")
+      options.retries = atoi(value);
+    else if (name == "min-timeout")
+      options.min_timeout_ms = atoi(value);
+    else if (name == "max-timeout")
+      options.max_timeout_ms = atoi(value);
+    else if (name == "temperature-max-interval")
+      options.temperature_max_interval_ms = atoi(value);
+    else {
+      int field = 0;
+      while (field < 5 && name != FIELD_OPTIONS[field])
+        field++;
+      if (field == 5)
+        usage();
+      options.field_interval_ms[field] = atoi(value);
+    }
+  }
+  return options;
+}
+
+// Tracks how long the published value of one field lags behind the controller
+struct Freshness {
+  int published_value{-1};
+  uint64_t changed_us{0};
+  bool pending{false};
+  std::vector<double> samples_s;
+
+  void changed(uint64_t now_us, int value) {
+    // a value that went back to what was published isn't stale, otherwise the oldest unpublished change counts
+    if (value == published_value) {
+      pending = false;
+    } else if (!pending) {
+      changed_us = now_us;
+      pending = true;
+    }
+  }
+  void published(uint64_t now_us, int value) {
+    if (pending && value != published_value)
+      samples_s.push_back((now_us - changed_us) / 1e6);
+    published_value = value;
+    pending = false;
+  }
+};
+
+static double percentile(std::vector<double> samples, double p) {
+  if (samples.empty())
+    return NAN;
+  std::sort(samples.begin(), samples.end());
+  size_t rank = std::max<size_t>(1, (size_t) std::ceil(p * samples.size()));
+  return samples[rank - 1];
+}
+
+static double next_event_us(std::mt19937 &rng, double mean_s) {
+  return std::exponential_distribution<double>(1.0 / (mean_s * 1e6))(rng);
+}
+
+// Records when the driver publishes the values of one channel
+struct ChannelProbe : esphome::wavinAhc9000::WavinChannelListener {
+  Freshness temperature, output;
+
+  void on_temperature(float value) override { temperature.published(sim_now_us, lroundf(value * 10)); }
+  void on_output(bool value) override { output.published(sim_now_us, value); }
+};
+
+// One simulated controller with the hub that polls it
+struct Controller {
+  Controller(const SimConfig &config, SimLine *line) : sim(config, line) {}
+
+  Ahc9000Sim sim;
+  esphome::wavinAhc9000::WavinAhc9000 driver;
+  esphome::sensor::Sensor requests, timeouts, invalid_replies, rtt_mean, scan_duration;
+  ChannelProbe probe[CHANNELS];
+  uint64_t next_temperature_us[CHANNELS], next_output_us[CHANNELS];
+};
+
+int main(int argc, char **argv) {
+  Options options = parse_options(argc, argv);
+  std::mt19937 rng(options.sim.seed + 1);
+  SimLine line;
+  esphome::modbus::Modbus bus;
+  bus.set_transmit_callback([&](const uint8_t *data, size_t len) { line.transmit(data, len, sim_now_us); });
+
+  std::vector<std::unique_ptr<Controller>> controllers;
+  for (int i = 0; i < options.controllers; i++) {
+    SimConfig config = options.sim;
+    config.address = options.sim.address + i;
+    config.seed = options.sim.seed + 100 * i;
+    controllers.push_back(std::make_unique<Controller>(config, &line));
+    Controller &c = *controllers.back();
+    auto &driver = c.driver;
+    driver.set_parent(&bus);
+    driver.set_address(config.address);
+    driver.set_update_interval(options.update_interval_ms);
+    driver.set_min_timeout(options.min_timeout_ms);
+    driver.set_max_timeout(options.max_timeout_ms);
+    driver.set_retries(options.retries);
+    driver.set_output_interval(options.field_interval_ms[0]);
+    driver.set_temperature_interval(options.field_interval_ms[1]);
+    driver.set_battery_interval(options.field_interval_ms[2]);
+    driver.set_setpoint_interval(options.field_interval_ms[3]);
+    driver.set_mode_interval(options.field_interval_ms[4]);
+    driver.set_temperature_max_interval(options.temperature_max_interval_ms);
+    driver.set_requests_sensor(&c.requests);
+    driver.set_timeouts_sensor(&c.timeouts);
+    driver.set_invalid_replies_sensor(&c.invalid_replies);
+    driver.set_rtt_mean_sensor(&c.rtt_mean);
+    driver.set_scan_duration_sensor(&c.scan_duration);
+    for (int channel = 0; channel < CHANNELS; channel++) {
+      c.next_temperature_us[channel] = next_event_us(rng, options.temperature_change_s);
+      c.next_output_us[channel] = next_event_us(rng, options.output_change_s);
+      driver.set_channel_listener(channel, &c.probe[channel]);
+    }
+  }
+
+  for (auto &c : controllers)
+    c->driver.setup();
+  uint64_t end_us = options.duration_s * 1000000ULL;
+  uint64_t next_update_us = 0;
+  uint32_t updates = 0;
+  for (sim_now_us = 0; sim_now_us < end_us; sim_now_us += STEP_US) {
+    for (auto &c : controllers) {
+      Ahc9000Sim &sim = c->sim;
+      sim.deliver(sim_now_us, [&](const std::vector<uint8_t> &data) { c->driver.on_modbus_data(data); });
+      for (int channel = 0; channel < CHANNELS; channel++) {
+        if (!sim.is_used(channel))
+          continue;
+        if (sim_now_us >= c->next_temperature_us[channel]) {
+          sim.set_air_temperature(channel, sim.air_temperature(channel) + ((rng() & 1) ? 1 : -1));
+          c->probe[channel].temperature.changed(sim_now_us, sim.air_temperature(channel));
+          c->next_temperature_us[channel] += next_event_us(rng, options.temperature_change_s);
+        }
+        if (sim_now_us >= c->next_output_us[channel]) {
+          sim.set_output(channel, !sim.output(channel));
+          c->probe[channel].output.changed(sim_now_us, sim.output(channel));
+          c->next_output_us[channel] += next_event_us(rng, options.output_change_s);
+        }
+      }
+    }
+    if (sim_now_us >= next_update_us) {
+      for (auto &c : controllers)
+        c->driver.update();
+      updates++;
+      next_update_us += options.update_interval_ms * 1000ULL;
+    }
+    for (auto &c : controllers)
+      c->driver.loop();
+  }
+
+  const LineStats &line_stats = line.stats();
+  printf("simulated %u s, %u update intervals of %u ms, %d controller(s)\n", options.duration_s, updates,
+         options.update_interval_ms, options.controllers);
+  printf("line: %u frames, %u collisions, occupancy %.3f%%\n", line_stats.frames, line_stats.collisions,
+         100.0 * line_stats.busy_us / end_us);
+  for (auto &c : controllers) {
+    const BusStats &stats = c->sim.stats();
+    printf("\ncontroller %d: requests %u, replies %u, dropped %u, corrupted %u, malformed %u\n", c->sim.address(),
+           stats.requests, stats.replies, stats.dropped, stats.corrupted, stats.malformed);
+    printf("driver: requests %.0f, timeouts %.0f, invalid replies %.0f, rtt %.1f ms, last scan %.0f ms\n",
+           c->requests.state, c->timeouts.state, c->invalid_replies.state, c->rtt_mean.state, c->scan_duration.state);
+    printf("transactions per update interval %.1f\n", (double) stats.requests / updates);
+    printf("time to fresh data in s     temperature p50     p99    n   output p50     p99    n\n");
+    std::vector<double> all_temperature, all_output;
+    for (int channel = 0; channel < CHANNELS; channel++) {
+      if (!c->sim.is_used(channel))
+        continue;
+      const auto &t = c->probe[channel].temperature.samples_s, &o = c->probe[channel].output.samples_s;
+      printf("channel %2d                        %7.2f %7.2f %4zu      %7.2f %7.2f %4zu\n", channel + 1,
+             percentile(t, 0.5), percentile(t, 0.99), t.size(), percentile(o, 0.5), percentile(o, 0.99), o.size());
+      all_temperature.insert(all_temperature.end(), t.begin(), t.end());
+      all_output.insert(all_output.end(), o.begin(), o.end());
+    }
+    printf("all                               %7.2f %7.2f %4zu      %7.2f %7.2f %4zu\n",
+           percentile(all_temperature, 0.5), percentile(all_temperature, 0.99), all_temperature.size(),
+           percentile(all_output, 0.5), percentile(all_output, 0.99), all_output.size());
+  }
+  return 0;
+}